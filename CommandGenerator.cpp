@@ -1,6 +1,5 @@
 #include "Terminal.h"
 #include <functional>
-#include <iostream>
 #include <map>
 #include "Utils.h"
 
@@ -11,18 +10,75 @@
  * **/
 
 using CommandFunction = std::function<void(const std::string& source, const std::string& date)>;
-inline std::map<std::string, CommandFunction> buildCommandsMap(Terminal &terminal, Graph<std::string>& graphs) {
+
+// Runs a query through the cache, key is the command and its parameters,
+// A hit replays the results the same query wrote on the same generation of the graphs.
+inline void cached_query(QueryCache& cache, const Graph<std::string>& graphs, ResultWriter& writer,
+                         const std::string& key, const std::function<void()>& query) {
+    const auto* results = cache.find(key, graphs.get_generation());
+    if (results) {
+        writer.replay(*results);
+        return;
+    }
+    std::vector<ResultWriter::Result> recorded;
+    writer.record(&recorded);
+    try {
+        query();
+    }catch (...) {
+        writer.record(nullptr);
+        throw;
+    }
+    writer.record(nullptr);
+    cache.insert(key, graphs.get_generation(), std::move(recorded));
+}
+
+// Parses the parameters of the top commands, <k>[,containers|voyages], returns false if they are wrong.
+inline bool parse_top(const std::string& count, const std::string& order, size_t& k, bool& by_voyages) {
+    int number = 0;
+    if (!scan_number(count.data(), count.size(), number) || number <= 0) return false;
+    if (!order.empty() && order != "containers" && order != "voyages") return false;
+    k = static_cast<size_t>(number);
+    by_voyages = order == "voyages";
+    return true;
+}
+
+inline std::map<std::string, CommandFunction> buildCommandsMap(Terminal &terminal, ResultWriter& writer,
+                                                               QueryCache& cache) {
     std::map<std::string,CommandFunction> commandsMap;
 
+    /**
+     * Inbound, outbound, balance, balance_series, route, maxflow and earliest results are cached (see QueryCache),
+     * until the next change of the graphs.
+     * Queries read the latest version of the graphs (terminal.snapshot()), it stays the same until they end,
+     * even if a server client loads files at the same time.
+     ***/
+
     /**
      * Load command, if one of the parameters is wrong, print the error message, otherwise load the file into
      * the graph.
+     * load <file> [<file> ...] with more than 1 file, or glob patterns, (load voyages/v?.dat)
+     * parses all the files in parallel and loads them in the given order.
      ***/
-    commandsMap["load"] = [&terminal](const std::string& filename, const std::string& date) {
+    commandsMap["load"] = [&terminal, &writer](const std::string& filename, const std::string& date) {
+        const auto files = split_words(filename);
+        if (!date.empty() || files.empty()) {
+            printError(writer);
+        }else if (files.size() == 1 && !is_glob(files[0])) {
+            terminal.load(files[0].c_str(), writer);
+        }else {
+            terminal.load_files(expand_files(files), writer);
+        }
+    };
+
+    /**
+     * Unload command, if one of the parameters is wrong, print the error message, otherwise remove every voyage
+     * loaded from the file (same name as it was loaded with) from the graphs.
+     ***/
+    commandsMap["unload"] = [&terminal, &writer](const std::string& filename, const std::string& date) {
         if (date.empty() && !filename.empty()) {
-            terminal.load(filename.c_str());
+            terminal.unload(filename, writer);
         }else {
-            printError();
+            printError(writer);
         }
     };
 
@@ -30,11 +86,14 @@ inline std::map<std::string, CommandFunction> buildCommandsMap(Terminal &termina
     * Inbound command, if one of the parameters is wrong, print the error message, otherwise print the reachable
     * nodes to source.
     ***/
-    commandsMap["inbound"] = [&graphs](const std::string& source, const std::string& date) {
+    commandsMap["inbound"] = [&terminal, &writer, &cache](const std::string& source, const std::string& date) {
         if (date.empty() && !source.empty()) {
-            graphs.reachable_nodes_to_source(source);
+            const auto graphs = terminal.snapshot();
+            cached_query(cache, *graphs, writer, "inbound\n" + source, [&]() {
+                graphs->reachable_nodes_to_source(source, writer);
+            });
         }else {
-            printError();
+            printError(writer);
         }
     };
 
@@ -42,11 +101,82 @@ inline std::map<std::string, CommandFunction> buildCommandsMap(Terminal &termina
     * Outbound command, if one of the parameters is wrong, print the error message, otherwise print the reachable
     * neighbor nodes from source.
     ***/
-    commandsMap["outbound"] = [&graphs](const std::string& source, const std::string& date) {
+    commandsMap["outbound"] = [&terminal, &writer, &cache](const std::string& source, const std::string& date) {
         if (date.empty() && !source.empty()) {
-            graphs.get_immediate_neighbors(source);
+            const auto graphs = terminal.snapshot();
+            cached_query(cache, *graphs, writer, "outbound\n" + source, [&]() {
+                graphs->get_immediate_neighbors(source, writer);
+            });
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Balance series command, <source>,balance_series,<from>,<to>,<step> if one of the parameters is wrong, print the
+    * error message, otherwise print the container balance at source from the date from to the date to,
+    * every step minutes.
+    ***/
+    commandsMap["balance_series"] = [&terminal, &writer, &cache](const std::string& source,
+                                                               const std::string& arguments) {
+        const auto fields = split_line(arguments);
+        int step = 0;
+        if (!source.empty() && fields.size() == 3 && isValidDateTime(fields[0]) && isValidDateTime(fields[1]) &&
+            scan_number(fields[2].data(), fields[2].size(), step) && step > 0 &&
+            datetime(fields[0]) <= datetime(fields[1])) {
+            const auto graphs = terminal.snapshot();
+            cached_query(cache, *graphs, writer, "balance_series\n" + source + "\n" + arguments, [&]() {
+                graphs->balance_series(source, fields[0], fields[1], step, writer);
+            });
         }else {
-            printError();
+            printError(writer);
+        }
+    };
+
+    /**
+    * Route command, <source>,route,<target> if one of the parameters is wrong, print the error message,
+    * otherwise print the fastest route (averaged sailing minutes) from source to target and its total minutes.
+    ***/
+    commandsMap["route"] = [&terminal, &writer, &cache](const std::string& source, const std::string& target) {
+        if (!source.empty() && !target.empty()) {
+            const auto graphs = terminal.snapshot();
+            cached_query(cache, *graphs, writer, "route\n" + source + "\n" + target, [&]() {
+                graphs->fastest_route(source, target, writer);
+            });
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Maxflow command, <source>,maxflow,<target> if one of the parameters is wrong, print the error message,
+    * otherwise print the bottleneck arcs and the maximum container flow from source to target.
+    ***/
+    commandsMap["maxflow"] = [&terminal, &writer, &cache](const std::string& source, const std::string& target) {
+        if (!source.empty() && !target.empty()) {
+            const auto graphs = terminal.snapshot();
+            cached_query(cache, *graphs, writer, "maxflow\n" + source + "\n" + target, [&]() {
+                graphs->max_flow(source, target, writer);
+            });
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Earliest command, <source>,earliest,<target>,dd/mm HH:mm if one of the parameters is wrong, print the error
+    * message, otherwise print the itinerary of real sails that arrives at target the earliest, leaving at the date.
+    ***/
+    commandsMap["earliest"] = [&terminal, &writer, &cache](const std::string& source, const std::string& arguments) {
+        const size_t comma = arguments.rfind(',');
+        if (!source.empty() && comma != std::string::npos && comma != 0 &&
+            isValidDateTime(arguments.substr(comma + 1))) {
+            const auto graphs = terminal.snapshot();
+            cached_query(cache, *graphs, writer, "earliest\n" + source + "\n" + arguments, [&]() {
+                graphs->earliest_arrival(source, arguments.substr(0, comma), arguments.substr(comma + 1), writer);
+            });
+        }else {
+            printError(writer);
         }
     };
 
@@ -54,26 +184,156 @@ inline std::map<std::string, CommandFunction> buildCommandsMap(Terminal &termina
     * Balance command, if one of the parameters is wrong, print the error message, otherwise print the
     * container balance at source via the provided date.
     ***/
-    commandsMap["balance"] = [&graphs](const std::string& source, const std::string& date) {
+    commandsMap["balance"] = [&terminal, &writer, &cache](const std::string& source, const std::string& date) {
         bool flag = false;
         if (!source.empty() && !date.empty()) {
             if (check_input(source,date,"0",date)) {
-                std::cout << graphs.balance(source,date) << "\n";
+                const auto graphs = terminal.snapshot();
+                cached_query(cache, *graphs, writer, "balance\n" + source + "\n" + date, [&]() {
+                    writer.number(graphs->balance(source,date));
+                });
                 flag = true;
             }
         }
-        if (!flag) printError();
+        if (!flag) printError(writer);
+    };
+    /**
+    * Top ports command, top_ports,<k>[,containers|voyages] if one of the parameters is wrong, print the error message,
+    * otherwise print the k busiest ports, ranked by containers handled (default) or by voyages.
+    ***/
+    commandsMap["top_ports"] = [&terminal, &writer](const std::string& count, const std::string& order) {
+        size_t k = 0;
+        bool by_voyages = false;
+        if (parse_top(count, order, k, by_voyages)) {
+            terminal.snapshot()->top_ports(k, by_voyages, writer);
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Top routes command, top_routes,<k>[,containers|voyages] if one of the parameters is wrong, print the error
+    * message, otherwise print the k heaviest lanes (source to destination), ranked by containers (default) or voyages.
+    ***/
+    commandsMap["top_routes"] = [&terminal, &writer](const std::string& count, const std::string& order) {
+        size_t k = 0;
+        bool by_voyages = false;
+        if (parse_top(count, order, k, by_voyages)) {
+            terminal.snapshot()->top_routes(k, by_voyages, writer);
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Balances command, balances,dd/mm HH:mm[,<file>] if one of the parameters is wrong, print the error message,
+    * otherwise print the container balance of every port (sorted by name) at the date, into the file if provided.
+    ***/
+    commandsMap["balances"] = [&terminal, &writer](const std::string& date, const std::string& filename) {
+        if (isValidDateTime(date)) {
+            terminal.write_balances(date, filename, writer);
+        }else {
+            printError(writer);
+        }
     };
+
     /**
-    * Print command, if one of the parameters is wrong, print the error message, otherwise print the
-    * the container graph and timing graph into a provided output file, if output file isnt provided,
-    * prints into the default file -> output.dat.
+    * Cache command, if one of the parameters is wrong, print the error message, otherwise print the
+    * hits, misses, entries and capacity of the query results cache.
     ***/
-    commandsMap["print"] = [&terminal](const std::string& source, const std::string& date) {
+    commandsMap["cache"] = [&cache, &writer](const std::string& source, const std::string& date) {
         if (source.empty() && date.empty()) {
-            terminal.write_output_file();
+            writer.row("hits", static_cast<long long>(cache.get_hits()));
+            writer.row("misses", static_cast<long long>(cache.get_misses()));
+            writer.row("entries", static_cast<long long>(cache.size()));
+            writer.row("capacity", static_cast<long long>(cache.get_capacity()));
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Stats command, if one of the parameters is wrong, print the error message, otherwise print the count and
+    * latencies of every command, the ingest counters, the size of the graphs and the cache counters.
+    ***/
+    commandsMap["stats"] = [&terminal, &writer, &cache](const std::string& source, const std::string& date) {
+        if (source.empty() && date.empty()) {
+            terminal.write_stats(writer, cache);
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Print command, print <file> if one of the parameters is wrong, print the error message, otherwise print the
+    * the container graph and timing graph into the provided file, if a file isnt provided,
+    * prints into the output file. (-o, or the default file -> output.dat)
+    ***/
+    commandsMap["print"] = [&terminal, &writer](const std::string& filename, const std::string& date) {
+        if (date.empty()) {
+            terminal.write_output_file(filename);
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Save command, if one of the parameters is wrong, print the error message, otherwise write the whole
+    * network into a binary snapshot file.
+    ***/
+    commandsMap["save"] = [&terminal, &writer](const std::string& filename, const std::string& date) {
+        if (date.empty() && !filename.empty()) {
+            terminal.save(filename, writer);
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Restore command, if one of the parameters is wrong, print the error message, otherwise replace the whole
+    * network with a binary snapshot file written by save.
+    ***/
+    commandsMap["restore"] = [&terminal, &writer](const std::string& filename, const std::string& date) {
+        if (date.empty() && !filename.empty()) {
+            terminal.restore(filename, writer);
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Archive command, if one of the parameters is wrong, print the error message, otherwise write every loaded
+    * voyage into a compressed archive file.
+    ***/
+    commandsMap["archive"] = [&terminal, &writer](const std::string& filename, const std::string& date) {
+        if (date.empty() && !filename.empty()) {
+            terminal.archive(filename, writer);
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * Load archive command, if one of the parameters is wrong, print the error message, otherwise load every voyage
+    * of an archive file written by archive, they can be unloaded with the archive file name.
+    ***/
+    commandsMap["load_archive"] = [&terminal, &writer](const std::string& filename, const std::string& date) {
+        if (date.empty() && !filename.empty()) {
+            terminal.load_archive(filename, writer);
+        }else {
+            printError(writer);
+        }
+    };
+
+    /**
+    * History command, if one of the parameters is wrong, print the error message, otherwise open an archive file
+    * as history, its voyages are added to balance, balance_series and balances without being loaded.
+    ***/
+    commandsMap["history"] = [&terminal, &writer](const std::string& filename, const std::string& date) {
+        if (date.empty() && !filename.empty()) {
+            terminal.history(filename, writer);
         }else {
-            printError();
+            printError(writer);
         }
     };
     return commandsMap;
@@ -0,0 +1,70 @@
+#include "ConnectionScanner.h"
+#include <algorithm>
+
+// Sorted by departure, ties by arrival, so a leg that takes no time comes before the legs leaving at its arrival.
+static bool earlier(const Connection& a, const Connection& b) {
+    if (a.departure != b.departure) return a.departure < b.departure;
+    if (a.arrival != b.arrival) return a.arrival < b.arrival;
+    return a.trip < b.trip;
+}
+
+void ConnectionScanner::sort(std::vector<Connection>& connections) {
+    std::stable_sort(connections.begin(), connections.end(), earlier);     // Legs of a trip keep their order.
+}
+
+bool ConnectionScanner::earliest_arrival(const std::vector<Connection>& connections, const size_t ports,
+                                         const size_t trips, const uint32_t source, const uint32_t target,
+                                         const TimeStamp start, std::vector<Ride>& rides) {
+    rides.clear();
+    if (source >= ports || target >= ports) return false;
+    if (source == target) return true;
+
+    if (stamp.size() < ports) {                     // The graph grew, new ports are unreached.
+        arrival.resize(ports);
+        entered.resize(ports);
+        reached_by.resize(ports);
+        stamp.resize(ports, generation);            // Older than the generation of this query.
+    }
+    if (trip_stamp.size() < trips) {
+        boarded.resize(trips);
+        trip_stamp.resize(trips, generation);
+    }
+
+    if (++generation == 0) {                        // Wrapped around, every stamp is old again.
+        std::fill(stamp.begin(), stamp.end(), 0);
+        std::fill(trip_stamp.begin(), trip_stamp.end(), 0);
+        generation = 1;
+    }
+    stamp[source] = generation;
+    arrival[source] = start.get_minutes();
+
+    const Connection first{0, 0, start.get_minutes(), start.get_minutes(), 0};
+    auto begin = std::lower_bound(connections.begin(), connections.end(), first,
+                                  [](const Connection& a, const Connection& b) { return a.departure < b.departure; });
+
+    for (auto c = begin; c != connections.end(); ++c) {
+        if (reached(target) && arrival[target] <= c->departure) break;     // Nothing later can arrive earlier.
+
+        const auto index = static_cast<uint32_t>(c - connections.begin());
+        if (trip_stamp[c->trip] != generation) {
+            if (!reached(c->from) || arrival[c->from] > c->departure) continue;    // Not at the port in time.
+            trip_stamp[c->trip] = generation;
+            boarded[c->trip] = index;
+        }
+        if (!reached(c->to) || c->arrival < arrival[c->to]) {
+            stamp[c->to] = generation;
+            arrival[c->to] = c->arrival;
+            entered[c->to] = boarded[c->trip];
+            reached_by[c->to] = index;
+        }
+    }
+    if (!reached(target)) return false;
+
+    for (uint32_t port = target; port != source; ) {                       // Walk the rides back to source.
+        const Connection& enter = connections[entered[port]];
+        rides.push_back(Ride{enter.from, port, TimeStamp(enter.departure), TimeStamp(connections[reached_by[port]].arrival)});
+        port = enter.from;
+    }
+    std::reverse(rides.begin(), rides.end());
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef CONNECTIONSCANNER_H
+#define CONNECTIONSCANNER_H
+
+#include <cstdint>
+#include <vector>
+#include "TimeStamp.h"
+
+// A single leg of a real sail, from port to port. (port ids)
+struct Connection {
+    uint32_t from;          // Port the leg departs from.
+    uint32_t to;            // Port the leg arrives at.
+    int32_t departure;      // Departure minutes.
+    int32_t arrival;        // Arrival minutes.
+    uint32_t trip;          // Dense index of the sail the leg belongs to, legs of a trip are consecutive in time.
+};
+
+/**
+ *  ConnectionScanner class
+ *  This class answers earliest arrival queries over the real sails, (Connection Scan Algorithm)
+ *  All legs of all sails are kept (by the Graph) in a single array sorted by departure time, a query binary searches
+ *  the start time and then scans the legs once, in order, until no later leg can improve the target.
+ *  A leg can be taken if its sail was already boarded, or if the traveler is at its port before it departs,
+ *  So transfers between sails at a port are free as long as the next sail did not leave yet.
+ *  The scanner only holds the per port and per trip buffers of a query, they are kept between queries,
+ *  grow with the graph and are reset lazily by a generation stamp. A thread needs its own scanner.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers and value types,
+ *  the compiler-generated versions are enough.
+ ***/
+class ConnectionScanner {
+public:
+    // A part of an itinerary on a single sail.
+    struct Ride {
+        uint32_t from;          // Boarding port.
+        uint32_t to;            // Leaving port.
+        TimeStamp departure;    // Departure from the boarding port.
+        TimeStamp arrival;      // Arrival at the leaving port.
+    };
+
+private:
+    std::vector<int32_t> arrival;           // Earliest arrival at every port, valid if stamp == generation.
+    std::vector<uint32_t> stamp;            // Generation of the last query that reached every port.
+    std::vector<uint32_t> entered;          // Connection that boarded the ride which reached every port.
+    std::vector<uint32_t> reached_by;       // Connection that reached every port.
+    std::vector<uint32_t> boarded;          // First connection of every trip taken, valid if trip_stamp == generation.
+    std::vector<uint32_t> trip_stamp;       // Generation of the last query that boarded every trip.
+    uint32_t generation = 0;                // Current query.
+
+    bool reached(const uint32_t port) const { return stamp[port] == generation; }
+
+public:
+    // Sorts connections by departure time, the order earliest_arrival scans them in.
+    static void sort(std::vector<Connection>& connections);
+
+    // Finds the earliest arrival at target leaving source at start or later, over sorted connections
+    // Of ports port ids and trips trip indexes, fills rides in order, Returns false if no sail reaches target.
+    bool earliest_arrival(const std::vector<Connection>& connections, size_t ports, size_t trips,
+                          uint32_t source, uint32_t target, TimeStamp start, std::vector<Ride>& rides);
+};
+
+#endif //CONNECTIONSCANNER_H
@@ -0,0 +1,25 @@
+#include "CsrGraph.h"
+
+void CsrGraph::build(const std::vector<Node>& nodes, const EdgeList list) {
+    offsets.assign(nodes.size() + 1, 0);
+    for (size_t v = 0; v < nodes.size(); ++v) {
+        uint32_t live = 0;
+        for (const auto& edge : (nodes[v].*list)())
+            live += !edge.is_removed();
+        offsets[v + 1] = offsets[v] + live;
+    }
+
+    targets.resize(offsets.back());
+    weights.resize(offsets.back());
+    sail_ids.resize(offsets.back());
+
+    for (size_t v = 0; v < nodes.size(); ++v) {
+        const auto& edges = (nodes[v].*list)();
+        for (size_t i = 0, e = offsets[v]; i < edges.size(); ++i) {
+            if (edges[i].is_removed()) continue;            // Unloaded voyage.
+            targets[e] = edges[i].get_destination();
+            weights[e] = edges[i].get_weight();
+            sail_ids[e++] = edges[i].get_sail_id();
+        }
+    }
+}
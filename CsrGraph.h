@@ -0,0 +1,42 @@
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <cstdint>
+#include <vector>
+#include "Node.h"
+
+/**
+ *  CsrGraph class
+ *  This class represents one of the graphs (container / timing, outbound / inbound) in compressed sparse row form.
+ *  The edges of port v are the indexes [begin(v), end(v)) of the targets, weights and sail_ids arrays,
+ *  So a traversal reads 4 contiguous arrays instead of following pointers from Node to Node.
+ *  It is compiled from the Nodes of a Graph once, and rebuilt only after the Graph changed.
+ *  Removed edges (see Edge::remove) are left out.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers,
+ *  the compiler-generated versions are enough.
+ ***/
+class CsrGraph {
+    std::vector<uint32_t> offsets;          // Edges of port v start at offsets[v], size = ports + 1.
+    std::vector<uint32_t> targets;          // Port id on the other end of every edge.
+    std::vector<int> weights;               // Weight of every edge.
+    std::vector<int> sail_ids;              // Unique sail_id of every edge.
+
+public:
+    using EdgeList = const std::vector<Edge>& (Node::*)() const;
+
+    // Compiles the edges selected by list (for example &Node::get_timing_edges) of every node.
+    void build(const std::vector<Node>& nodes, EdgeList list);
+
+    uint32_t begin(const uint32_t port) const { return offsets[port]; }             // First edge of port.
+    uint32_t end(const uint32_t port) const { return offsets[port + 1]; }           // One past the last edge of port.
+    uint32_t get_target(const uint32_t edge) const { return targets[edge]; }        // Target getter.
+    int get_weight(const uint32_t edge) const { return weights[edge]; }             // Weight getter.
+    int get_sail_id(const uint32_t edge) const { return sail_ids[edge]; }           // Unique id getter.
+
+    size_t port_count() const { return offsets.empty() ? 0 : offsets.size() - 1; }  // Number of ports.
+    size_t edge_count() const { return targets.size(); }                            // Number of edges.
+};
+
+#endif //CSRGRAPH_H
@@ -1,37 +1,38 @@
 #ifndef EDGE_H
 #define EDGE_H
 
-#include <memory>
-#include <utility>
-#include "SailDetails.h"
+#include <cstdint>
+
+#define REMOVED_EDGE UINT32_MAX  // Destination of an edge whose voyage was unloaded.
 
 /**
- *  Generic Edge class
+ *  Edge class
  *  This class represents an edge, each Node contains a vector of edges, (source to lots of destinations)
- *  Each edge uses a weak_ptr to destination Node, has its own weight,
+ *  Each edge holds the interned id of the port on its other end, has its own weight,
  *  And a unique sail_id for identification later on.
+ *  Port names are resolved through the Graph's PortInterner, only when printing.
+ *  Unloading a voyage does not erase its edges, they are marked removed (tombstones) and skipped when compiled,
+ *  So the positions of the other edges (see Route) stay valid, until half of the edges are removed and
+ *  Graph::compact_edges erases them.
  *
  *  The big 3:
- *  I only create and hold references to other nodes via smart pointers.
- *  Since there's no special copy or cleanup behavior needed, I rely on the compiler-generated versions
- *  thus, no need for the Big 3.
+ *  Not implemented because this class only contains value types,
+ *  the compiler-generated versions are enough.
  ***/
-template<typename T>    // Forward declaration.
-class Node;
-
-template<typename T>
 class Edge {
-    std::weak_ptr<Node<T>> destination;     // Weak pointer to destination.
+    uint32_t destination;                   // Port id of the destination.
     int weight;                             // The weight of the edge.
     int sail_id;                            // Unique sail_id.
 
 public:
-    explicit Edge(std::shared_ptr<Node<T>> _dest, const int _weight, const int _sail_id)    // Default ctor.
-    : destination(std::move(_dest)), weight(_weight), sail_id(_sail_id) {}
+    explicit Edge(const uint32_t _dest, const int _weight, const int _sail_id)              // Default ctor.
+    : destination(_dest), weight(_weight), sail_id(_sail_id) {}
     int get_weight() const { return weight; }                                               // Weight getter.
     void set_weight(const int w) { weight = w; }                                            // Weight setter. (updating)
     int get_sail_id() const { return sail_id; }                                             // Unique id getter.
-    const std::weak_ptr<Node<T>>& get_destination() const { return destination; }           // Destination getter.
+    uint32_t get_destination() const { return destination; }                                // Destination getter.
+    void remove() { destination = REMOVED_EDGE; }                                           // Marks the edge removed.
+    bool is_removed() const { return destination == REMOVED_EDGE; }                         // Removed check.
 };
 
-#endif //EDGE_H
\ No newline at end of file
+#endif //EDGE_H
@@ -35,7 +35,7 @@ public:
 // Custom exception that is used when running the program with invalid arguments.
 class InvalidFileArgumentsException final : public FileException {
 public:
-    explicit InvalidFileArgumentsException() : FileException("USAGE: -i <infile1> [<infile2> ...]\n") {}
+    explicit InvalidFileArgumentsException() : FileException("USAGE: [--snapshot <file>] -i <infile1> [<infile2> ...]\n") {}
 };
 
 // Custom exception that is used for invalid files that cannot be opened or read from.
@@ -44,4 +44,35 @@ public:
     explicit FileNotFoundException(const std::string& file_name) : FileException("ERROR opening/reading the specified file. <" + file_name + ">\n") {}
 };
 
+// Custom exception that is used for unloading a file that is not loaded.
+class FileNotLoadedException final : public FileException {
+public:
+    explicit FileNotLoadedException(const std::string& file_name) : FileException("File <" + file_name + "> is not loaded.\n") {}
+};
+
+// Custom exception that is used for snapshot files that are truncated, corrupted or of another version.
+class InvalidSnapshotException final : public FileException {
+public:
+    explicit InvalidSnapshotException(const std::string& file_name) : FileException("Invalid snapshot file <" + file_name + ">.\n") {}
+};
+
+// Custom exception that is used for archive files that are truncated, corrupted or of another version.
+class InvalidArchiveException final : public FileException {
+public:
+    explicit InvalidArchiveException(const std::string& file_name) : FileException("Invalid archive file <" + file_name + ">.\n") {}
+};
+
+// Custom exception that is used for a voyage whose unique id does not follow the ids of the loaded voyages.
+class InvalidVoyageIdException final : public FileException {
+public:
+    explicit InvalidVoyageIdException(const int id) : FileException("Voyage id " + std::to_string(id) + " does not follow the loaded voyages.\n") {}
+};
+
+// Custom exception that is used when the voyages of a file, archive or snapshot are both loaded and in the history,
+// a voyage is recognized by its ports, times and containers, so distinct voyages that are identical are refused too.
+class HistoryOverlapException final : public FileException {
+public:
+    explicit HistoryOverlapException(const std::string& file_name) : FileException("File <" + file_name + "> has a voyage that is both loaded and in the history, (the same ports, times and containers) it is refused so its containers are not counted twice.\n") {}
+};
+
 #endif //FILEEXCEPTION_H
\ No newline at end of file
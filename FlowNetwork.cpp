@@ -0,0 +1,47 @@
+#include "FlowNetwork.h"
+
+#define NO_PAIR UINT32_MAX  // Port not connected to the port being aggregated.
+
+void FlowNetwork::build(const CsrGraph& graph) {
+    const uint32_t ports = static_cast<uint32_t>(graph.port_count());
+
+    // Aggregate the edges of every port, pair[v] is the (port, v) pair while port is scanned.
+    std::vector<uint32_t> pair(ports, NO_PAIR), sources, sinks;
+    std::vector<long long> sums;
+    for (uint32_t port = 0; port < ports; ++port) {
+        for (uint32_t e = graph.begin(port); e < graph.end(port); ++e) {
+            const uint32_t target = graph.get_target(e);
+            if (target == port) continue;                       // Self loops never carry flow.
+            if (pair[target] == NO_PAIR || sources[pair[target]] != port) {
+                pair[target] = static_cast<uint32_t>(sources.size());
+                sources.push_back(port);
+                sinks.push_back(target);
+                sums.push_back(0);
+            }
+            sums[pair[target]] += graph.get_weight(e);
+        }
+    }
+
+    // Every pair is an arc source -> sink and its reverse arc sink -> source.
+    offsets.assign(ports + 1, 0);
+    for (size_t p = 0; p < sources.size(); ++p) {
+        ++offsets[sources[p] + 1];
+        ++offsets[sinks[p] + 1];
+    }
+    for (uint32_t port = 0; port < ports; ++port)
+        offsets[port + 1] += offsets[port];
+
+    targets.resize(offsets.back());
+    reverses.resize(offsets.back());
+    capacities.resize(offsets.back());
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for (size_t p = 0; p < sources.size(); ++p) {
+        const uint32_t arc = next[sources[p]]++, reverse = next[sinks[p]]++;
+        targets[arc] = sinks[p];
+        capacities[arc] = sums[p];
+        reverses[arc] = reverse;
+        targets[reverse] = sources[p];
+        capacities[reverse] = 0;
+        reverses[reverse] = arc;
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef FLOWNETWORK_H
+#define FLOWNETWORK_H
+
+#include <cstdint>
+#include <vector>
+#include "CsrGraph.h"
+
+/**
+ *  FlowNetwork class
+ *  This class represents the container graph as a residual network for max flow queries. (see MaxFlow)
+ *  The parallel edges of every pair of ports (a container edge per sail) are aggregated into a single arc,
+ *  whose capacity is the sum of their containers, self loops are left out.
+ *  Every arc has a reverse arc of capacity 0, the arcs of port v are the indexes [begin(v), end(v)) of the
+ *  targets, capacities and reverses arrays, so a query never follows a pointer.
+ *  It is compiled from the compiled container graph once, and rebuilt only after the Graph changed.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers,
+ *  the compiler-generated versions are enough.
+ ***/
+class FlowNetwork {
+    std::vector<uint32_t> offsets;          // Arcs of port v start at offsets[v], size = ports + 1.
+    std::vector<uint32_t> targets;          // Port id on the other end of every arc.
+    std::vector<uint32_t> reverses;         // Index of the reverse arc of every arc.
+    std::vector<long long> capacities;      // Containers of every arc, 0 for reverse arcs.
+
+public:
+    // Compiles the aggregated arcs of every port of a compiled container graph.
+    void build(const CsrGraph& graph);
+
+    uint32_t begin(const uint32_t port) const { return offsets[port]; }             // First arc of port.
+    uint32_t end(const uint32_t port) const { return offsets[port + 1]; }           // One past the last arc of port.
+    uint32_t get_target(const uint32_t arc) const { return targets[arc]; }          // Target getter.
+    uint32_t get_reverse(const uint32_t arc) const { return reverses[arc]; }        // Reverse arc getter.
+    long long get_capacity(const uint32_t arc) const { return capacities[arc]; }    // Capacity getter.
+    const std::vector<long long>& get_capacities() const { return capacities; }     // Capacity of every arc.
+
+    size_t port_count() const { return offsets.empty() ? 0 : offsets.size() - 1; }  // Number of ports.
+    size_t arc_count() const { return targets.size(); }                             // Number of arcs.
+};
+
+#endif //FLOWNETWORK_H
@@ -1,14 +1,26 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
-#include <memory>
+#include <algorithm>
 #include <fstream>
+#include <memory>
 #include <unordered_map>
 #include "SailDetails.h"
 #include "Node.h"
-#include <iomanip>
-#include <iostream>
+#include "CsrGraph.h"
+#include "PortInterner.h"
+#include "Route.h"
+#include "RoutePlanner.h"
+#include "ConnectionScanner.h"
+#include "FlowNetwork.h"
+#include "MaxFlow.h"
+#include "VoyageStore.h"
+#include "TrafficIndex.h"
+#include "VoyageArchive.h"
 #include "Utils.h"
+#include "ResultWriter.h"
+#include "FileException.h"
+#include "OutputWriter.h"
 #define SPACE_AMOUNT 16 // Used for printing spaces inside outputfile.
 
 /**
@@ -16,180 +28,602 @@
  *  This class represents a generic graph, where each node (port) can be connected
  *  to others in two ways: a container graph and a timing graph.
  *  The graph stores:
- *   - dual_graph: maps each port name to a Node that holds edges to other ports,
- *   - sailing_details: maps each unique sail_id to its historical SailDetails entries.
+ *   - ports: interns each port name into a dense id,
+ *   - dual_graph: the Node of every port id, holding edges (by id) to other ports,
+ *   - voyages: the legs of every voyage (by unique sail_id), stored as columns of port ids and times,
+ *     sail_ids are consecutive, next_id is copied with every version of the Graph, (see Terminal::update)
+ *   - routes: maps each (source, destination) pair of the timing graph to its Route aggregate,
+ *   - files: the unique sail_ids of the voyages loaded from every file, so a file can be unloaded again,
+ *   - port_traffic / lane_traffic: containers and voyages of every port and of every (source, destination) lane
+ *     of the container graph, updated by every voyage loaded or unloaded, ranked on the next top query. (see TrafficIndex)
+ *   - history: an archive of older voyages, (see VoyageArchive) its containers are added to the balance queries.
+ *  Queries and printing run on compressed sparse row copies of the graphs (CsrGraph), compiled
+ *  from dual_graph on the first query after a change, names are resolved only when printing.
  *  The class provides methods to build the graph from file input, check for specific sail entries,
- *  compute reachability, balance container flows, and output the graph to a file.
+ *  compute reachability, fastest routes, earliest arrivals and max container flows, balance container flows,
+ *  and output the graph to a file.
  *
  *  The Big 3:
  *  I do not implement the Big 3 (copy constructor, assignment operator, destructor)
- *  because this class uses only standard containers and smart pointers,
+ *  because this class uses only standard containers and value types,
  *  all of which are automatically managed.
  */
+class Snapshot;
+
 template<typename T>
 class Graph {
-    std::unordered_map<T, std::shared_ptr<Node<T>>> dual_graph;         // Source key - > value is a container graph and a timing graph.
-    std::unordered_map<int, std::vector<SailDetails>> sailing_details;  // Unique sail_id key -> vector of SailDetails.
-public:
+    friend class Snapshot;                                              // Saves and restores the whole Graph.
+
+    PortInterner<T> ports;                                              // Port name <-> port id.
+    std::vector<Node> dual_graph;                                       // Port id -> container graph and timing graph.
+    VoyageStore voyages;                                                // Unique sail_id -> legs of the voyage.
+    std::unordered_map<uint64_t, Route> routes;                         // Route::key(source, destination) -> timing edge.
+    std::unordered_map<std::string, std::vector<int32_t>> files;        // File name -> sail_ids loaded from it.
+    int32_t next_id = 0;                                                // Unique sail_id of the next voyage.
+    size_t edge_count = 0;                                              // Edges of the 4 edge sets, removed included.
+    size_t removed_edges = 0;                                           // Removed edges, compacted at edge_count / 2.
+    mutable TrafficIndex<uint32_t> port_traffic;                        // Port id -> containers handled, voyages.
+    mutable TrafficIndex<uint64_t> lane_traffic;                        // Route::key(source, destination) -> totals.
+    uint64_t generation = 0;                                            // Bumped on every change. (see QueryCache)
+    std::shared_ptr<const VoyageArchive> history;                       // Archived voyages, shared by all versions.
+
+    mutable CsrGraph container_graph;       // Compiled container graph.
+    mutable CsrGraph timing_graph;          // Compiled timing graph.
+    mutable CsrGraph inbound_timing_graph;  // Compiled reverse timing graph.
+    mutable bool compiled = false;          // False after any change, until compile() runs.
 
-    // Adds all the file contents into the 2 maps.
-    void add_file(const std::string &source, const std::vector<SailDetails> &database,
-                 const std::vector<std::string> &destinations) {
-        add_port(source);
+    mutable std::vector<Connection> connections;            // Legs of all voyages, sorted by departure time.
+    mutable bool connections_compiled = false;              // False after any change, until compile_connections() runs.
 
-        std::string timing_edge = source;
-        auto& edges = dual_graph.at(source)->get_container_edges();
+    mutable FlowNetwork flow_network;       // Aggregated container graph, for max flow queries.
+    mutable bool flow_compiled = false;     // False after any change, until compile_flow() runs.
+public:
+
+    // Adds all the file contents into the 2 maps, the voyage is recorded under file_name. (see unload)
+    // Throws InvalidVoyageIdException, before anything is added, if next_id does not follow the voyages,
+    // And HistoryOverlapException if the voyage is in the history, its containers would be counted twice.
+    // (a voyage of the history with the same ports, times and containers, see fingerprint, only while one is open)
+    void add_file(const T &source, const std::vector<SailDetails> &database,
+                 const std::vector<T> &destinations, const std::string& file_name) {
+        if (!voyages.accepts(next_id)) throw InvalidVoyageIdException(next_id);
+        if (history && history->contains(fingerprint(source, database, destinations)))
+            throw HistoryOverlapException(file_name);
+        const uint32_t source_id = add_port(source);
+        std::vector<uint32_t> destination_ids(destinations.size());
+        for (size_t j = 0; j < destinations.size(); ++j)
+            destination_ids[j] = add_port(destinations[j]);      // Intern first, dual_graph may grow.
 
+        uint32_t timing_edge = source_id;
         for (size_t i = 1, j = 0; i < database.size() ; ++i, ++j) {
-            add_port(destinations[j]);
-            edges.emplace_back(dual_graph.at(destinations[j]),database[i].get_containers(),SailDetails::uniqueID);  // Connect source to *all* destinations (container graph)
+            const uint32_t destination = destination_ids[j];
+            dual_graph[source_id].get_container_edges().emplace_back(destination,database[i].get_containers(),next_id);  // Connect source to *all* destinations (container graph)
+            dual_graph[destination].get_inbound_container_edges().emplace_back(source_id,database[i].get_containers(),next_id);
+            edge_count += 2;
 
-            if (!check_existence(timing_edge,destinations[j],database[i])) {    // Check the existence of edge update if needed
-                dual_graph[timing_edge]->get_timing_edges().emplace_back(dual_graph.at(destinations[j]),database[i].get_timings(),SailDetails::uniqueID);   // Connect source to destination (timing graph)
+            if (!check_existence(timing_edge,destination,database[i])) {    // Check the existence of edge update if needed
+                auto& outbound = dual_graph[timing_edge].get_timing_edges();
+                auto& inbound = dual_graph[destination].get_inbound_timing_edges();
+                routes.emplace(Route::key(timing_edge, destination),
+                               Route(static_cast<uint32_t>(outbound.size()), static_cast<uint32_t>(inbound.size()),
+                                     database[i].get_timings()));
+                outbound.emplace_back(destination,database[i].get_timings(),next_id);   // Connect source to destination (timing graph)
+                inbound.emplace_back(timing_edge,database[i].get_timings(),next_id);
+                edge_count += 2;
             }
-            timing_edge = destinations[j];  // Used for timing graph connections
+            timing_edge = destination;  // Used for timing graph connections
         }
 
-        sailing_details[SailDetails::uniqueID] = database;  // Move the database to my SailDetails database
-        SailDetails::next_unique_id();                      // Next sail id
+        voyages.add(next_id, source_id, database, destination_ids);   // Keep the voyage legs
+        replay_timeline(voyages.size() - 1, false);
+        count_traffic(voyages.size() - 1, 1);
+        files[file_name].push_back(next_id);
+        ++next_id;                                          // Next sail id
+        compiled = false;
+        connections_compiled = false;
+        flow_compiled = false;
+        ++generation;
     }
 
     // Check if the edge already exists. (avg time update)
-    bool check_existence(const std::string& source, const std::string& destination, const SailDetails& details) {
-        auto& edges = dual_graph.at(source)->get_timing_edges();
-        for (size_t i = 0; i < edges.size(); ++i) {                         // Iterate over source edges
-            if (const auto& edge = edges[i].get_destination().lock()){
-                if (edge->get_source() == destination) {                    // Source goes to dest found!
-                    auto& sails = sailing_details[edges[i].get_sail_id()];
-                    for (size_t j = 0; j < sails.size(); ++j) {             // Iterate over all sails to find sail and update
-                        if (sails[j].get_destination() == destination) {
-                            sails[j].set_avg_timings(details.get_timings());
-                            edges[i].set_weight(sails[j].get_timings());
-                            return true;
-                        }
-                    }
+    bool check_existence(const uint32_t source, const uint32_t destination, const SailDetails& details) {
+        const auto found = routes.find(Route::key(source, destination));
+        if (found == routes.end()) return false;
+
+        Route& route = found->second;
+        Edge& edge = dual_graph[source].get_timing_edges()[route.get_edge()];
+        edge.set_weight(route.add_timings(details.get_timings()));
+        dual_graph[destination].get_inbound_timing_edges()[route.get_inbound_edge()].set_weight(edge.get_weight());
+        return true;
+    }
+
+    // Replays voyage index v of the voyage store once, and adds its container events to the timelines of
+    // the ports it touches, or erases them if remove is set. (see unload) The events added are merged by the next
+    // read of a timeline, once for all the voyages of a load. (see Timeline::commit)
+    // The events are the ones of VoyageStore::for_each_event.
+    void replay_timeline(const size_t v, const bool remove) {
+        voyages.for_each_event(v, [&](const uint32_t port, const TimeStamp time, const int delta) {
+            if (remove) dual_graph[port].get_timeline().remove_event(time, delta);
+            else dual_graph[port].get_timeline().add_event(time, delta);
+        });
+    }
+
+    // Adds (sign 1) or takes out (sign -1) the containers of voyage index v into the traffic of its ports and lanes,
+    // Every port and lane counts the voyage once, the source handles the containers loaded (and unloaded if it is
+    // also a destination), every destination the containers unloaded in it. A voyage of an empty file has no legs,
+    // and no traffic.
+    void count_traffic(const size_t v, const int sign) {
+        const uint32_t first = voyages.begin(v), last = voyages.end(v);
+        if (first == last) return;
+        const uint32_t source = voyages.get_port(first);
+        std::vector<std::pair<uint32_t, long long>> unloaded;          // (destination, containers) of every leg.
+        long long at_source = 0;
+        for (uint32_t leg = first + 1; leg < last; ++leg) {
+            unloaded.emplace_back(voyages.get_port(leg), voyages.get_containers(leg));
+            at_source += voyages.get_containers(leg);
+        }
+        std::sort(unloaded.begin(), unloaded.end());
+        for (size_t i = 0; i < unloaded.size(); ) {
+            const uint32_t port = unloaded[i].first;
+            long long containers = 0;
+            for (; i < unloaded.size() && unloaded[i].first == port; ++i)
+                containers += unloaded[i].second;
+            lane_traffic.add(Route::key(source, port), sign * containers, sign);
+            if (port == source) at_source += containers;
+            else port_traffic.add(port, sign * containers, sign);
+        }
+        port_traffic.add(source, sign * at_source, sign);
+    }
+
+    // Removes every voyage loaded from file_name, (see remove_voyage) returns the number of voyages removed,
+    // 0 if file_name was not loaded. Once the removed edges are half of all edges they are erased. (see compact_edges)
+    size_t unload(const std::string& file_name) {
+        const auto found = files.find(file_name);
+        if (found == files.end()) return 0;
+
+        for (const int32_t id : found->second)
+            remove_voyage(voyages.index(id));
+        const size_t removed = found->second.size();
+        files.erase(found);
+        if (removed_edges * 2 > edge_count) compact_edges();
+        compiled = false;
+        connections_compiled = false;
+        flow_compiled = false;
+        ++generation;
+        return removed;
+    }
+
+    // Takes voyage index v out of the graphs in O(legs * log(edges + events)) amortized, not in the size of the graphs:
+    // Its container edges are found by a binary search and marked removed, its timings are taken out of the route
+    // aggregates (a route without sails is removed), its container events become tombstones of the timelines,
+    // (see Timeline::remove_event) and its voyage slot is marked removed. Removed edges are erased by compact_edges.
+    void remove_voyage(const size_t v) {
+        const int32_t id = voyages.id(v);
+        const uint32_t first = voyages.begin(v), last = voyages.end(v);
+        if (first != last)                                  // Not the voyage of an empty file.
+            remove_edges(dual_graph[voyages.get_port(first)].get_container_edges(), id);
+
+        for (uint32_t leg = first + 1; leg < last; ++leg) {
+            const uint32_t source = voyages.get_port(leg - 1), destination = voyages.get_port(leg);
+            remove_edges(dual_graph[destination].get_inbound_container_edges(), id);
+
+            const auto found = routes.find(Route::key(source, destination));
+            if (found == routes.end()) continue;
+            Route& route = found->second;
+            Edge& edge = dual_graph[source].get_timing_edges()[route.get_edge()];
+            Edge& inbound = dual_graph[destination].get_inbound_timing_edges()[route.get_inbound_edge()];
+            edge.set_weight(route.remove_timings(voyages.get_minutes(leg)));
+            inbound.set_weight(edge.get_weight());
+            if (route.get_count() == 0) {
+                edge.remove();
+                inbound.remove();
+                removed_edges += 2;
+                routes.erase(found);
+            }
+        }
+        replay_timeline(v, true);
+        count_traffic(v, -1);
+        voyages.remove(v);
+    }
+
+    // Fingerprint of a voyage before it is added, the same as VoyageStore::fingerprint once it is.
+    static uint64_t fingerprint(const T& source, const std::vector<SailDetails>& database, const std::vector<T>& destinations) {
+        uint64_t hash = FNV_OFFSET;
+        for (size_t i = 0; i < database.size(); ++i)
+            hash = VoyageStore::fingerprint_leg(hash, i == 0 ? source : destinations[i - 1],
+                                                database[i].get_departure().get_minutes(),
+                                                i == 0 ? 0 : database[i].get_timings(), i == 0 ? 0 : database[i].get_containers());
+        return hash;
+    }
+
+    // Marks the edges of sail id removed, edges are added in sail_id order so they are found by a binary search.
+    void remove_edges(std::vector<Edge>& edges, const int id) {
+        auto edge = std::lower_bound(edges.begin(), edges.end(), id,
+                                     [](const Edge& e, const int sail_id) { return e.get_sail_id() < sail_id; });
+        for (; edge != edges.end() && edge->get_sail_id() == id; ++edge) {
+            edge->remove();
+            ++removed_edges;
+        }
+    }
+
+    // Erases every removed edge, (O(edges), once per edge_count / 2 removed edges, so O(1) amortized per edge)
+    // And moves every route to the new positions of its timing edges, the sail_id order of the edges is kept.
+    void compact_edges() {
+        const auto removed = [](const Edge& edge) { return edge.is_removed(); };
+        for (uint32_t port = 0; port < dual_graph.size(); ++port) {
+            Node& node = dual_graph[port];
+            for (std::vector<Edge>* edges : {&node.get_container_edges(), &node.get_timing_edges(),
+                                             &node.get_inbound_container_edges(), &node.get_inbound_timing_edges()})
+                edges->erase(std::remove_if(edges->begin(), edges->end(), removed), edges->end());
+
+            const auto& outbound = node.get_timing_edges();         // A live timing edge per route.
+            for (uint32_t e = 0; e < outbound.size(); ++e)
+                routes.at(Route::key(port, outbound[e].get_destination())).set_edge(e);
+            const auto& inbound = node.get_inbound_timing_edges();
+            for (uint32_t e = 0; e < inbound.size(); ++e)
+                routes.at(Route::key(inbound[e].get_destination(), port)).set_inbound_edge(e);
+        }
+        edge_count -= removed_edges;
+        removed_edges = 0;
+    }
+
+    // Counts the edges of every node, and the removed ones. (see Snapshot::restore)
+    void count_edges() {
+        edge_count = removed_edges = 0;
+        for (const Node& node : dual_graph)
+            for (const std::vector<Edge>* edges : {&node.get_container_edges(), &node.get_timing_edges(),
+                                                   &node.get_inbound_container_edges(), &node.get_inbound_timing_edges()})
+                for (const Edge& edge : *edges) {
+                    ++edge_count;
+                    removed_edges += edge.is_removed();
                 }
+    }
+
+    // Adds every voyage of archive, recorded under file_name. (see unload)
+    void add_archive(const VoyageArchive& archive, const std::string& file_name) {
+        if (history && history->overlaps(archive)) throw HistoryOverlapException(file_name);    // Nothing added.
+        VoyageStore legs;
+        std::vector<SailDetails> database;
+        std::vector<T> destinations;
+        for (size_t block = 0; block < archive.block_count(); ++block) {
+            archive.decode(block, legs);
+            for (size_t v = 0; v < legs.size(); ++v) {
+                const uint32_t first = legs.begin(v);
+                const T& source = archive.name(legs.get_port(first));
+                database.assign(1, SailDetails(0, 0, legs.get_departure(first), source));
+                destinations.clear();
+                for (uint32_t leg = first + 1; leg < legs.end(v); ++leg) {
+                    destinations.push_back(archive.name(legs.get_port(leg)));
+                    database.emplace_back(legs.get_containers(leg), legs.get_minutes(leg), legs.get_departure(leg),
+                                          destinations.back());
+                }
+                add_file(source, database, destinations, file_name);
             }
         }
+    }
+
+    // Encodes every loaded voyage into archive.
+    void archive(VoyageArchive& archive) const {
+        std::vector<std::string> names(ports.size());
+        for (uint32_t port = 0; port < ports.size(); ++port) names[port] = ports.name(port);
+        archive.build(voyages, names);
+    }
+
+    // Replaces the archived voyages added to the balance queries, read from file_name.
+    // Throws HistoryOverlapException, and the history is not changed, if a loaded voyage is in archive.
+    void set_history(std::shared_ptr<const VoyageArchive> archive, const std::string& file_name) {
+        if (archive && overlaps(*archive)) throw HistoryOverlapException(file_name);
+        history = std::move(archive);
+        ++generation;
+    }
+
+    // True if a voyage that is not removed is in archive. (see VoyageStore::fingerprint)
+    bool overlaps(const VoyageArchive& archive) const {
+        const auto name = [this](const uint32_t port) -> const std::string& { return ports.name(port); };
+        for (size_t v = 0; v < voyages.size(); ++v)
+            if (!voyages.is_removed(v) && archive.contains(voyages.fingerprint(v, name))) return true;
         return false;
     }
 
-    // Adds a port into the map.
-    void add_port(const T& src) {
-        if (dual_graph.find(src) != dual_graph.end()) return;
-        dual_graph[src] = std::make_shared<Node<T>>(src);
+    // Adds a port into the map, returns its id.
+    uint32_t add_port(const T& src) {
+        const uint32_t id = ports.intern(src);
+        if (id == dual_graph.size()) dual_graph.emplace_back();
+        return id;
     }
 
-    // Prints all neighbors from source, via a single step.
-    void get_immediate_neighbors(const T& source_port) const {
-        if (dual_graph.find(source_port) == dual_graph.end()) {
-            std::cout << source_port <<" does not exist in the database." << std::endl;;
-            return;
+    uint64_t get_generation() const { return generation; }     // Generation getter.
+
+    size_t port_count() const { return ports.size(); }                  // Number of ports.
+    size_t voyage_count() const { return voyages.size() - voyages.removed_count(); }    // Number of voyages loaded.
+
+    // Number of edges of the container graph.
+    size_t container_edge_count() const {
+        size_t edges = 0;
+        for (const Node& node : dual_graph)
+            for (const Edge& edge : node.get_container_edges()) edges += !edge.is_removed();
+        return edges;
+    }
+
+    // Number of edges of the timing graph. (one per route)
+    size_t timing_edge_count() const { return routes.size(); }
+
+    // Compiles the CSR graphs used by the queries, if anything changed since the last compile.
+    void compile() const {
+        if (compiled) return;
+        container_graph.build(dual_graph, &Node::get_container_edges);
+        timing_graph.build(dual_graph, &Node::get_timing_edges);
+        inbound_timing_graph.build(dual_graph, &Node::get_inbound_timing_edges);
+        compiled = true;
+    }
+
+    // Collects the legs of every voyage into the connection scanner, (a sequential scan over the voyage store)
+    // Only earliest arrival queries need them, so they are compiled separately from the CSR graphs.
+    void compile_connections() const {
+        if (connections_compiled) return;
+        connections.clear();
+        connections.reserve(voyages.leg_count() - voyages.size());
+        for (size_t v = 0; v < voyages.size(); ++v) {
+            if (voyages.is_removed(v)) continue;
+            for (uint32_t leg = voyages.begin(v) + 1; leg < voyages.end(v); ++leg)
+                connections.push_back(Connection{voyages.get_port(leg - 1), voyages.get_port(leg),
+                                                 voyages.get_departure(leg - 1).get_minutes(),
+                                                 voyages.get_arrival(leg).get_minutes(), static_cast<uint32_t>(v)});
         }
-        const auto& edges = dual_graph.at(source_port)->get_timing_edges();
+        ConnectionScanner::sort(connections);
+        connections_compiled = true;
+    }
+
+    // Aggregates the compiled container graph into the flow network, only max flow queries need it.
+    void compile_flow() const {
+        if (flow_compiled) return;
+        compile();
+        flow_network.build(container_graph);
+        flow_compiled = true;
+    }
+
+    // Ranks the ports and lanes whose traffic changed since the last top query.
+    void rank_traffic() const {
+        if (!port_traffic.is_fresh()) port_traffic.refresh();
+        if (!lane_traffic.is_fresh()) lane_traffic.refresh();
+    }
+
+    // Compiles everything the queries compile lazily, after this no const method changes the Graph,
+    // So it can be read by many threads at once. (see Terminal::serve)
+    void prepare() const {
+        for (const Node& node : dual_graph)
+            node.get_timeline().commit();               // Reads of a published version never merge.
+        compile();
+        compile_connections();
+        compile_flow();
+        rank_traffic();
+        ports.sorted();
+    }
 
-        if (edges.empty()) {
-            std::cout << source_port <<": no outbound ports" << std::endl;;
+    // Writes all neighbors from source, via a single step.
+    void get_immediate_neighbors(const T& source_port, ResultWriter& writer) const {
+        const uint32_t source = ports.find(source_port);
+        if (source == NO_PORT) {
+            writer.message(source_port + " does not exist in the database.");
             return;
         }
-        for (size_t i = 0; i < edges.size(); ++i) {
-            if (const auto& edge = edges[i].get_destination().lock()) {
-                std::cout << edge->get_source() << "," << edges[i].get_weight() << std::endl;;
-            }
+        compile();
+        if (timing_graph.begin(source) == timing_graph.end(source)) {
+            writer.message(source_port + ": no outbound ports");
+            return;
+        }
+        for (uint32_t e = timing_graph.begin(source); e < timing_graph.end(source); ++e) {
+            writer.row(ports.name(timing_graph.get_target(e)), timing_graph.get_weight(e));
         }
     }
 
-    // Prints all nodes that are connected to target port.
-    void reachable_nodes_to_source(const T& target_port) const {
-        if (dual_graph.find(target_port) == dual_graph.end()) {
-            std::cout << target_port <<" does not exist in the database." << std::endl;;
+    // Writes all nodes that are connected to target port.
+    void reachable_nodes_to_source(const T& target_port, ResultWriter& writer) const {
+        const uint32_t target = ports.find(target_port);
+        if (target == NO_PORT) {
+            writer.message(target_port + " does not exist in the database.");
             return;
         }
+        compile();
         bool found = false;
-        for (const auto& key_val : dual_graph) {  // Iterate over the whole graph
-            if (key_val.first != target_port) {
-                auto& timing_edges = key_val.second->get_timing_edges();
-                for (size_t i = 0 ; i < timing_edges.size(); ++i) {                 // Iterate over the edges of the port that's not a target.
-                    if (const auto& destination = timing_edges[i].get_destination().lock()) {
-                        if (destination->get_source() == target_port) {             // port connected to target!
-                            std::cout << key_val.first << "," << timing_edges[i].get_weight() << std::endl;;
-                            found = true;
-                        }
-                    }
-                }
+        for (uint32_t e = inbound_timing_graph.begin(target); e < inbound_timing_graph.end(target); ++e) {
+            const uint32_t origin = inbound_timing_graph.get_target(e);
+            if (origin != target) {                                         // Self loops are not inbound ports.
+                writer.row(ports.name(origin), inbound_timing_graph.get_weight(e));
+                found = true;
             }
         }
         if (!found) {
-            std::cout << target_port << ": no inbound ports" << std::endl;;
+            writer.message(target_port + ": no inbound ports");
         }
     }
 
-    // Returns the container amount in target port provided a date.
-    int balance(const T& target_port, const std::string& date) {
-        if (dual_graph.find(target_port) == dual_graph.end()) return 0;
-        int balance = 0;
-
-        const SailDetails input_date(date);
-        const auto& edges = dual_graph.at(target_port)->get_container_edges();
+    // Writes the fastest route from source to target over the timing graph,
+    // Every port of the route with its minutes from source, then the total minutes.
+    void fastest_route(const T& source_port, const T& target_port, ResultWriter& writer) const {
+        const uint32_t source = ports.find(source_port), target = ports.find(target_port);
+        if (source == NO_PORT || target == NO_PORT) {
+            writer.message((source == NO_PORT ? source_port : target_port) + " does not exist in the database.");
+            return;
+        }
+        compile();
+        static thread_local RoutePlanner planner;           // Buffers reused by every route query of the thread.
+        static thread_local std::vector<uint32_t> path;
+        const long long total = planner.shortest_path(timing_graph, source, target, path);
+        if (total < 0) {
+            writer.message(source_port + ": no route to " + target_port);
+            return;
+        }
+        for (const uint32_t port : path)
+            writer.row(ports.name(port), planner.distance_to(port));
+        writer.number(total);
+    }
 
-        for (size_t i = 0; i < edges.size(); ++i) {             // Subtract all containers from target port outwards by date
-            const int uniqueID = edges[i].get_sail_id();
-            if(sailing_details[uniqueID][0] <= input_date)
-                balance -= edges[i].get_weight();
+    // Writes the itinerary that arrives at target the earliest, leaving source at date or later, using the real sails,
+    // Every ride as from,departure,to,arrival, then the total minutes from date to the arrival.
+    void earliest_arrival(const T& source_port, const T& target_port, const std::string& date,
+                          ResultWriter& writer) const {
+        const uint32_t source = ports.find(source_port), target = ports.find(target_port);
+        if (source == NO_PORT || target == NO_PORT) {
+            writer.message((source == NO_PORT ? source_port : target_port) + " does not exist in the database.");
+            return;
         }
+        compile_connections();
+        static thread_local ConnectionScanner scanner;      // Buffers reused by every earliest query of the thread.
+        static thread_local std::vector<ConnectionScanner::Ride> rides;
+        const TimeStamp start = datetime(date);
+        if (!scanner.earliest_arrival(connections, ports.size(), voyages.size(), source, target, start, rides)) {
+            writer.message(source_port + ": no sail to " + target_port + " after " + date);
+            return;
+        }
+        for (const auto& ride : rides)
+            writer.message(ports.name(ride.from) + "," + format_time(ride.departure) + "," +
+                           ports.name(ride.to) + "," + format_time(ride.arrival));
+        writer.number(rides.empty() ? 0 : rides.back().arrival - start);
+    }
 
-        for (auto& key_val : dual_graph) {  // Iterate over the whole graph to find Nodes connected to target
-            if (key_val.first != target_port) {
-                auto& container_edges = key_val.second->get_container_edges();
+    // Writes the maximum container flow from source to target over the aggregated container graph,
+    // The arcs of a minimum cut (the bottleneck) as from,to,containers, then the flow.
+    void max_flow(const T& source_port, const T& target_port, ResultWriter& writer) const {
+        const uint32_t source = ports.find(source_port), target = ports.find(target_port);
+        if (source == NO_PORT || target == NO_PORT) {
+            writer.message((source == NO_PORT ? source_port : target_port) + " does not exist in the database.");
+            return;
+        }
+        compile_flow();
+        static thread_local MaxFlow solver;                 // Buffers reused by every max flow query of the thread.
+        const long long flow = solver.max_flow(flow_network, source, target);
+        for (uint32_t port = 0; port < flow_network.port_count(); ++port) {
+            if (!solver.on_source_side(port)) continue;
+            for (uint32_t arc = flow_network.begin(port); arc < flow_network.end(port); ++arc) {
+                const uint32_t to = flow_network.get_target(arc);
+                if (flow_network.get_capacity(arc) > 0 && !solver.on_source_side(to))
+                    writer.message(ports.name(port) + "," + ports.name(to) + "," +
+                                   std::to_string(flow_network.get_capacity(arc)));
+            }
+        }
+        writer.number(flow);
+    }
 
-                for (size_t i = 0 ; i < container_edges.size(); ++i) {      // Iterate over the edges of every Node
-                    if (const auto& destination = container_edges[i].get_destination().lock()) {
-                        if (destination->get_source() == target_port) {     // Found a connection (any Node to Target)
+    // Writes the (at most) k busiest ports, by voyages or by containers handled, as port,containers,voyages.
+    void top_ports(const size_t k, const bool by_voyages, ResultWriter& writer) const {
+        rank_traffic();
+        std::vector<uint32_t> top;
+        port_traffic.top(k, by_voyages, top);
+        for (const uint32_t port : top) {
+            const Traffic& traffic = port_traffic.get(port);
+            writer.message(ports.name(port) + "," + std::to_string(traffic.containers) + "," +
+                           std::to_string(traffic.voyages));
+        }
+    }
 
-                            const int uniqueID = container_edges[i].get_sail_id();
-                            const auto& sail_vector = sailing_details[uniqueID];
+    // Writes the (at most) k heaviest lanes of the container graph, by voyages or by containers,
+    // As source,destination,containers,voyages.
+    void top_routes(const size_t k, const bool by_voyages, ResultWriter& writer) const {
+        rank_traffic();
+        std::vector<uint64_t> top;
+        lane_traffic.top(k, by_voyages, top);
+        for (const uint64_t lane : top) {
+            const Traffic& traffic = lane_traffic.get(lane);
+            writer.message(ports.name(static_cast<uint32_t>(lane >> 32)) + "," +
+                           ports.name(static_cast<uint32_t>(lane)) + "," + std::to_string(traffic.containers) +
+                           "," + std::to_string(traffic.voyages));
+        }
+    }
 
-                            std::tm starting_point = datetime(sail_vector[0].get_departure());
-                            std::time_t time = std::mktime(&starting_point);
+    // Returns the container amount in target port provided a date, archived voyages included.
+    int balance(const T& target_port, const std::string& date) const {
+        const TimeStamp time = datetime(date);
+        int balance = history ? history->balance_at(target_port, time) : 0;
+        const uint32_t target = ports.find(target_port);
+        if (target != NO_PORT)
+            balance += dual_graph[target].get_timeline().balance_at(time);
+        return balance;
+    }
 
-                            std::string departure;
-                            for (size_t j = 1; j < sail_vector.size(); ++j) {       // Check for any date errors (arrival - departure)
-                                time += sail_vector[j].get_timings() * MINUTES;
-                                const std::string formatted_time = format_time(time);
+    // Writes the container amount in target port at every step (minutes) from date from to date to, as time,balance.
+    void balance_series(const T& target_port, const std::string& from, const std::string& to, const int step,
+                        ResultWriter& writer) const {
+        const uint32_t target = ports.find(target_port);
+        const bool archived = history && history->find(target_port) != NO_PORT;
+        if (target == NO_PORT && !archived) {
+            writer.message(target_port + " does not exist in the database.");
+            return;
+        }
+        const TimeStamp start = datetime(from), end = datetime(to);
+        std::vector<int> balances, archived_balances;
+        if (target != NO_PORT)
+            dual_graph[target].get_timeline().balance_series(start, end, step, balances);
+        if (archived) {
+            history->balance_series(target_port, start, end, step, archived_balances);
+            balances.resize(archived_balances.size());
+            for (size_t i = 0; i < balances.size(); ++i) balances[i] += archived_balances[i];
+        }
+        for (size_t i = 0; i < balances.size(); ++i)
+            writer.row(format_time(start + static_cast<int>(i) * step), balances[i]);
+    }
 
-                                const SailDetails starting_point_date(formatted_time); // Found the sail, and date is valid, add balance and break
-                                if (starting_point_date <= input_date && sailing_details[uniqueID][j].get_destination() == target_port) {
-                                    balance += container_edges[i].get_weight();
-                                    break;
-                                }
+    // Writes the container amount of every port (sorted by name) at date,
+    // A single lookup in the timeline of every port, instead of a balance command per port.
+    // Ports of the archived voyages are merged in by name.
+    void balances(const std::string& date, ResultWriter& writer) const {
+        const TimeStamp time = datetime(date);
+        const std::vector<uint32_t>& live = ports.sorted();
+        std::vector<uint32_t> none;
+        std::vector<int> archived;
+        if (history) history->balances_at(time, archived);
+        const std::vector<uint32_t>& old = history ? history->sorted() : none;
 
-                                const SailDetails check_delay(sail_vector[j].get_departure());  // Check for any date delays
-                                if (starting_point_date <= check_delay) {
-                                    starting_point = datetime(check_delay.get_departure());
-                                    time = std::mktime(&starting_point);
-                                }
-                            }
-                        }
-                    }
-                }
+        size_t i = 0, j = 0;
+        while (i < live.size() || j < old.size()) {
+            if (j == old.size() || (i < live.size() && ports.name(live[i]) < history->name(old[j]))) {
+                writer.row(ports.name(live[i]), dual_graph[live[i]].get_timeline().balance_at(time));
+                ++i;
+            }else if (i == live.size() || history->name(old[j]) < ports.name(live[i])) {
+                writer.row(history->name(old[j]), archived[old[j]]);
+                ++j;
+            }else {
+                writer.row(ports.name(live[i]), dual_graph[live[i]].get_timeline().balance_at(time) + archived[old[j]]);
+                ++i;
+                ++j;
             }
         }
-        return balance;
     }
 
-    // Prints dual_graph into the outputfile.
-    void print(std::ofstream& file, bool flag) const {
-        if (!file.is_open()) return;
-        std::string category = flag ? "Containers" : "Time";
-        for ( auto& key_val : dual_graph) {
-            auto& edges = flag ? key_val.second->get_container_edges() : key_val.second->get_timing_edges();;
-            file << key_val.first << ":\n";
-            for (size_t i = 0 ; i < edges.size(); ++i)
-                if (const auto& container_edge = edges[i].get_destination().lock())
-                    file << "\t\t-" << std::left << std::setw(SPACE_AMOUNT) << container_edge->get_source()  << category <<  "(" << edges[i].get_weight() << ")\n";
+    // Appends port and its edges in graph to out, the lines the print command always wrote.
+    void print_port(const CsrGraph& graph, const uint32_t port, const char* category, std::string& out) const {
+        out += ports.name(port);
+        out += ":\n";
+        for (uint32_t e = graph.begin(port); e < graph.end(port); ++e) {
+            const T& target = ports.name(graph.get_target(e));
+            out += "\t\t-";
+            out += target;
+            if (target.size() < SPACE_AMOUNT) out.append(SPACE_AMOUNT - target.size(), ' ');
+            out += category;
+            out += std::to_string(graph.get_weight(e));
+            out += ")\n";
         }
-        file << "\n";
+    }
+
+    // Prints both graphs into file_name, the container graph and then the timing graph, each followed by an empty line.
+    // Ports are sorted by name, (the same file for the same network, whatever the load order) and formatted in
+    // parallel by writer, returns false if file_name cannot be written.
+    bool print(const std::string& file_name, const OutputWriter& writer) const {
+        compile();
+        const std::vector<uint32_t>& order = ports.sorted();     // Sorted before the workers start.
+        const size_t section = order.size() + 1;                 // Every port, then the empty line.
+        return writer.write(file_name, 2 * section, [this, &order, section](size_t item, const size_t last,
+                                                                           std::string& out) {
+            for (; item < last; ++item) {
+                const bool containers = item < section;
+                const size_t index = item % section;
+                if (index == order.size())
+                    out += '\n';
+                else
+                    print_port(containers ? container_graph : timing_graph, order[index],
+                               containers ? "Containers(" : "Time(", out);
+            }
+        });
     }
 };
 
-#endif //GRAPH_H
\ No newline at end of file
+#endif //GRAPH_H
@@ -0,0 +1,40 @@
+#include "IngestPool.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+IngestPool::IngestPool(const unsigned _workers) : workers(_workers) {
+    if (workers == 0) workers = std::thread::hardware_concurrency();
+    if (workers == 0) workers = 1;
+}
+
+std::vector<IngestPool::ParsedFile> IngestPool::parse(const std::vector<std::string>& file_names) const {
+    std::vector<ParsedFile> results(file_names.size());
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < file_names.size(); i = next++) {
+            results[i].file_name = file_names[i];
+            const MappedFile file(file_names[i]);
+            if (!file.is_open()) {
+                results[i].line_number = FILE_NOT_OPENED;
+                continue;
+            }
+            try {
+                results[i].line_number = results[i].voyage.read(file.begin(), file.end());
+            } catch (...) {
+                results[i].error = std::current_exception();
+            }
+        }
+    };
+
+    const size_t count = std::min<size_t>(workers, file_names.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < count; ++t)
+        threads.emplace_back(worker);
+    worker();                               // The calling thread works too.
+    for (auto& thread : threads)
+        thread.join();
+    return results;
+}
@@ -0,0 +1,40 @@
+#ifndef INGESTPOOL_H
+#define INGESTPOOL_H
+
+#include <exception>
+#include <string>
+#include <vector>
+#include "Voyage.h"
+
+#define FILE_NOT_OPENED (-1)    // ParsedFile::line_number of a file that could not be opened.
+
+/**
+ *  IngestPool class
+ *  This class parses and validates many input files at the same time, on a pool of worker threads.
+ *  Every worker takes the next file that was not taken yet, and parses it into its own Voyage.
+ *  The results are returned in the same order as the file names, so the caller can insert them into
+ *  the Graph one by one, exactly like the serial path does. (same output, same sail_ids)
+ *
+ *  The big 3:
+ *  Not implemented because this class only holds the number of workers,
+ *  the compiler-generated versions are enough.
+ ***/
+class IngestPool {
+    unsigned workers;           // Number of worker threads.
+
+public:
+    // The result of parsing a single file.
+    struct ParsedFile {
+        std::string file_name;
+        int line_number = 0;    // 0 if valid, FILE_NOT_OPENED, or the line number of the first error.
+        Voyage voyage;
+        std::exception_ptr error;   // Any exception thrown while parsing, rethrown by the caller.
+    };
+
+    explicit IngestPool(unsigned _workers = 0);     // 0 -> one worker per hardware thread.
+
+    // Parses all files, the i'th result belongs to file_names[i].
+    std::vector<ParsedFile> parse(const std::vector<std::string>& file_names) const;
+};
+
+#endif //INGESTPOOL_H
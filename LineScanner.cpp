@@ -0,0 +1,185 @@
+#include "LineScanner.h"
+#include <climits>
+#include "Utils.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCANNER_X86
+#include <immintrin.h>
+#endif
+
+#define DATE_DIGITS 0x6DB       // Bits of the digit positions of "dd/mm HH:mm". (0, 1, 3, 4, 6, 7, 9, 10)
+#define DATE_SEPARATORS 0x124   // Bits of the '/', ' ' and ':' positions. (2, 5, 8)
+#define DATE_MASK 0x7FF         // Bits of all 11 positions.
+#define TWO_DIGITS_ZERO ('0' * 11)  // '0' * 10 + '0', subtracted from 2 digits read as characters.
+
+// The shape of a date, the bytes after DATE_LENGTH are not compared.
+static const char DATE_TEMPLATE[SCANNER_WIDTH] = {'0', '0', '/', '0', '0', ' ', '0', '0', ':', '0', '0'};
+
+// Fields of a date whose shape was checked already.
+static bool date_fields(const char* text, TimeStamp& out) {
+    return TimeStamp::from_fields(text[0] * 10 + text[1] - TWO_DIGITS_ZERO, text[3] * 10 + text[4] - TWO_DIGITS_ZERO,
+                                  text[6] * 10 + text[7] - TWO_DIGITS_ZERO, text[9] * 10 + text[10] - TWO_DIGITS_ZERO,
+                                  out);
+}
+
+// Scalar separators of [from, end), offsets from begin.
+static void separators_tail(const char* begin, const char* from, const char* end, std::vector<size_t>& positions) {
+    for (const char* c = from; c != end; ++c)
+        if (*c == ',' || *c == '\n') positions.push_back(static_cast<size_t>(c - begin));
+}
+
+static void separators_scalar(const char* begin, const char* end, std::vector<size_t>& positions) {
+    positions.clear();
+    separators_tail(begin, begin, end, positions);
+}
+
+static bool dates_scalar(const char* first, const size_t first_length, const char* second, const size_t second_length,
+                         const char*, TimeStamp& first_out, TimeStamp& second_out) {
+    return TimeStamp::parse(first, first_length, first_out) &&
+           (second == nullptr || TimeStamp::parse(second, second_length, second_out));
+}
+
+static bool number_scalar(const char* text, const size_t length, const char*, int& out) {
+    return scan_number(text, length, out);
+}
+
+#ifdef SCANNER_X86
+// 0xFF in every byte of v that is a digit.
+__attribute__((target("sse2")))
+static __m128i digit_bytes(const __m128i v) {
+    const __m128i values = _mm_sub_epi8(v, _mm_set1_epi8('0'));                 // Digits -> 0..9, others -> 10..255.
+    return _mm_cmpeq_epi8(_mm_min_epu8(values, _mm_set1_epi8(9)), values);
+}
+
+__attribute__((target("sse2")))
+static void separators_sse2(const char* begin, const char* end, std::vector<size_t>& positions) {
+    positions.clear();
+    const __m128i comma = _mm_set1_epi8(','), newline = _mm_set1_epi8('\n');
+    const char* block = begin;
+    for (; end - block >= 16; block += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, newline))));
+        for (; mask != 0; mask &= mask - 1)
+            positions.push_back(static_cast<size_t>(block - begin) + __builtin_ctz(mask));
+    }
+    separators_tail(begin, block, end, positions);
+}
+
+__attribute__((target("sse2")))
+static bool date_sse2(const char* text, const size_t length, const char* end, TimeStamp& out) {
+    if (length != DATE_LENGTH) return false;
+    if (end - text < SCANNER_WIDTH) return TimeStamp::parse(text, length, out);
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+    const __m128i shape = _mm_loadu_si128(reinterpret_cast<const __m128i*>(DATE_TEMPLATE));
+    const int digits = _mm_movemask_epi8(digit_bytes(v)), separators = _mm_movemask_epi8(_mm_cmpeq_epi8(v, shape));
+    if (((digits & DATE_DIGITS) | (separators & DATE_SEPARATORS)) != DATE_MASK) return false;
+    return date_fields(text, out);
+}
+
+__attribute__((target("sse2")))
+static bool dates_sse2(const char* first, const size_t first_length, const char* second, const size_t second_length,
+                       const char* end, TimeStamp& first_out, TimeStamp& second_out) {
+    return date_sse2(first, first_length, end, first_out) &&
+           (second == nullptr || date_sse2(second, second_length, end, second_out));
+}
+
+// A count of up to SCANNER_WIDTH digits is checked by a single compare, then read without checks.
+__attribute__((target("sse2")))
+static bool number_sse2(const char* text, const size_t length, const char* end, int& out) {
+    if (length == 0 || length > SCANNER_WIDTH || end - text < SCANNER_WIDTH) return scan_number(text, length, out);
+    const unsigned field = (1U << length) - 1;
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+    if ((static_cast<unsigned>(_mm_movemask_epi8(digit_bytes(v))) & field) != field) return false;
+
+    long long value = 0;                            // Up to 16 digits, no overflow.
+    for (size_t i = 0; i < length; ++i)
+        value = value * 10 + (text[i] - '0');
+    if (value > INT_MAX) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+__attribute__((target("avx2")))
+static void separators_avx2(const char* begin, const char* end, std::vector<size_t>& positions) {
+    positions.clear();
+    const __m256i comma = _mm256_set1_epi8(','), newline = _mm256_set1_epi8('\n');
+    const char* block = begin;
+    for (; end - block >= 32; block += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+        unsigned mask = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, comma), _mm256_cmpeq_epi8(v, newline))));
+        for (; mask != 0; mask &= mask - 1)
+            positions.push_back(static_cast<size_t>(block - begin) + __builtin_ctz(mask));
+    }
+    separators_tail(begin, block, end, positions);
+}
+
+// Both dates of a line in the 2 halves of a single register.
+__attribute__((target("avx2")))
+static bool dates_avx2(const char* first, const size_t first_length, const char* second, const size_t second_length,
+                       const char* end, TimeStamp& first_out, TimeStamp& second_out) {
+    if (second == nullptr || end - first < SCANNER_WIDTH || end - second < SCANNER_WIDTH)
+        return dates_sse2(first, first_length, second, second_length, end, first_out, second_out);
+    if (first_length != DATE_LENGTH || second_length != DATE_LENGTH) return false;
+
+    const __m256i v = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(second)), 1);
+    const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(DATE_TEMPLATE));
+    const __m256i shape = _mm256_inserti128_si256(_mm256_castsi128_si256(half), half, 1);
+    const __m256i values = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    const unsigned digits = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_min_epu8(values, _mm256_set1_epi8(9)), values)));
+    const unsigned separators = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, shape)));
+    const unsigned both = (digits & (DATE_DIGITS | DATE_DIGITS << 16)) |
+                          (separators & (DATE_SEPARATORS | DATE_SEPARATORS << 16));
+    if (both != (DATE_MASK | DATE_MASK << 16)) return false;
+    return date_fields(first, first_out) && date_fields(second, second_out);
+}
+#endif
+
+LineScanner::LineScanner(const Kernel _kernel) : kernel(_kernel), separators_kernel(separators_scalar),
+                                                 dates_kernel(dates_scalar), number_kernel(number_scalar) {
+#ifdef SCANNER_X86
+    if (kernel == Kernel::SSE2) {
+        separators_kernel = separators_sse2;
+        dates_kernel = dates_sse2;
+        number_kernel = number_sse2;
+    }else if (kernel == Kernel::AVX2) {
+        separators_kernel = separators_avx2;
+        dates_kernel = dates_avx2;
+        number_kernel = number_sse2;            // A count fits in 16 bytes.
+    }
+#else
+    kernel = Kernel::SCALAR;
+#endif
+}
+
+bool LineScanner::is_supported(const Kernel kernel) {
+    if (kernel == Kernel::SCALAR) return true;
+#ifdef SCANNER_X86
+    __builtin_cpu_init();
+    if (kernel == Kernel::AVX2) return __builtin_cpu_supports("avx2");
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+LineScanner::Kernel LineScanner::best() {
+    if (is_supported(Kernel::AVX2)) return Kernel::AVX2;
+    if (is_supported(Kernel::SSE2)) return Kernel::SSE2;
+    return Kernel::SCALAR;
+}
+
+const LineScanner& LineScanner::get() {
+    static const LineScanner scanner(best());
+    return scanner;
+}
+
+std::string LineScanner::name(const Kernel kernel) {
+    if (kernel == Kernel::AVX2) return "avx2";
+    if (kernel == Kernel::SSE2) return "sse2";
+    return "scalar";
+}
@@ -0,0 +1,72 @@
+#ifndef LINESCANNER_H
+#define LINESCANNER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "TimeStamp.h"
+
+#define SCANNER_WIDTH 16        // Bytes read by a single vector load of a date or a number.
+
+/**
+ *  LineScanner class
+ *  This class holds the validation kernels of the file parser (see Voyage::read), in 3 versions:
+ *  scalar, SSE2 (16 bytes per instruction) and AVX2 (32 bytes per instruction), the best one the CPU supports
+ *  Is chosen once at runtime, all of them accept and reject exactly the same input. (see cargoBench --verify)
+ *   - separators: the positions of every ',' and '\n' of a whole file in a single pass, so the lines and fields
+ *     of all lines are found at once, instead of a memchr per line and per field,
+ *   - dates: checks the fixed "dd/mm HH:mm" shape (8 digits and 3 separators) with a single compare of the field
+ *     against a template, AVX2 checks the arrival and departure of a line together, the ranges are checked by
+ *     TimeStamp::from_fields,
+ *   - number: checks that every character of a container count is a digit with a single compare.
+ *  A vector load reads SCANNER_WIDTH bytes from the start of a field, so it is only used when that many bytes are
+ *  left before the end of the file, the scalar code handles the last bytes.
+ *
+ *  The big 3:
+ *  Not implemented because this class only holds the kernel and function pointers,
+ *  the compiler-generated versions are enough.
+ ***/
+class LineScanner {
+public:
+    enum class Kernel { SCALAR, SSE2, AVX2 };
+
+    using Separators = void (*)(const char* begin, const char* end, std::vector<size_t>& positions);
+    using Dates = bool (*)(const char* first, size_t first_length, const char* second, size_t second_length,
+                           const char* end, TimeStamp& first_out, TimeStamp& second_out);
+    using Number = bool (*)(const char* text, size_t length, const char* end, int& out);
+
+private:
+    Kernel kernel;
+    Separators separators_kernel;
+    Dates dates_kernel;
+    Number number_kernel;
+
+public:
+    explicit LineScanner(Kernel _kernel);           // The kernel must be supported. (see is_supported)
+
+    static bool is_supported(Kernel kernel);        // True if the CPU can run kernel.
+    static Kernel best();                           // The widest kernel the CPU can run.
+    static const LineScanner& get();                // The scanner of the best kernel, chosen on the first call.
+    static std::string name(Kernel kernel);         // "scalar", "sse2" or "avx2".
+
+    Kernel get_kernel() const { return kernel; }    // Kernel getter.
+
+    // Fills positions with the offset (from begin) of every ',' and '\n' in [begin, end), in order.
+    void separators(const char* begin, const char* end, std::vector<size_t>& positions) const {
+        separators_kernel(begin, end, positions);
+    }
+
+    // Parses 2 "dd/mm HH:mm" dates, same rules as TimeStamp::parse, false if one of them is not valid.
+    // end is the end of the file, (no byte at or after it is read) second may be null to parse first alone.
+    bool dates(const char* first, const size_t first_length, const char* second, const size_t second_length,
+               const char* end, TimeStamp& first_out, TimeStamp& second_out) const {
+        return dates_kernel(first, first_length, second, second_length, end, first_out, second_out);
+    }
+
+    // Parses a container count, same rules as scan_number in Utils.h.
+    bool number(const char* text, const size_t length, const char* end, int& out) const {
+        return number_kernel(text, length, end, out);
+    }
+};
+
+#endif //LINESCANNER_H
@@ -0,0 +1,38 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define READ_CHUNK 65536
+
+MappedFile::MappedFile(const std::string& file_name) {
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    opened = true;
+
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* memory = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (memory != MAP_FAILED) {
+            madvise(memory, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            data = static_cast<const char*>(memory);
+            size = static_cast<size_t>(info.st_size);
+            mapped = true;
+        }
+    }
+    if (!mapped) {                          // Not a regular file, or mmap failed, read it instead.
+        ssize_t bytes = 0;
+        do {
+            buffer.resize(size + READ_CHUNK);
+            bytes = read(fd, buffer.data() + size, READ_CHUNK);
+            if (bytes > 0) size += static_cast<size_t>(bytes);
+        } while (bytes > 0);
+        data = buffer.data();
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (mapped) munmap(const_cast<char*>(data), size);
+}
@@ -0,0 +1,36 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ *  MappedFile class
+ *  This class maps a whole file into memory (read only), so it can be parsed in place without copying
+ *  Every line into a std::string first.
+ *  Files that cannot be mapped (pipes, special files) are read into a buffer instead.
+ *
+ *  The big 5:
+ *  The destructor unmaps the file, copying is deleted because 2 objects must never unmap the same memory,
+ *  and moving is not needed, a MappedFile lives in the scope that parses it.
+ ***/
+class MappedFile {
+    const char* data = nullptr;         // First byte of the file.
+    size_t size = 0;                    // Number of bytes.
+    bool mapped = false;                // True if data must be unmapped.
+    bool opened = false;                // True if the file could be opened.
+    std::vector<char> buffer;           // Holds the file if it could not be mapped.
+
+public:
+    explicit MappedFile(const std::string& file_name);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    bool is_open() const { return opened; }             // True if the file could be opened.
+    const char* begin() const { return data; }          // First byte.
+    const char* end() const { return data + size; }     // One past the last byte.
+};
+
+#endif //MAPPEDFILE_H
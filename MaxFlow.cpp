@@ -0,0 +1,79 @@
+#include "MaxFlow.h"
+#include <algorithm>
+
+bool MaxFlow::build_levels(const FlowNetwork& network, const uint32_t source, const uint32_t target) {
+    std::fill(level.begin(), level.end(), -1);
+    queue.clear();
+    level[source] = 0;
+    queue.push_back(source);
+    for (size_t next = 0; next < queue.size(); ++next) {
+        const uint32_t port = queue[next];
+        for (uint32_t arc = network.begin(port); arc < network.end(port); ++arc) {
+            const uint32_t to = network.get_target(arc);
+            if (residual[arc] > 0 && level[to] < 0) {
+                level[to] = level[port] + 1;
+                queue.push_back(to);
+            }
+        }
+    }
+    return level[target] >= 0;
+}
+
+long long MaxFlow::blocking_flow(const FlowNetwork& network, const uint32_t source, const uint32_t target) {
+    for (uint32_t port = 0; port < network.port_count(); ++port)
+        current[port] = network.begin(port);
+
+    long long flow = 0;
+    path.clear();
+    uint32_t port = source;
+    while (true) {
+        if (port == target) {                                   // Push the bottleneck of the path.
+            long long pushed = residual[path[0]];
+            for (const uint32_t arc : path)
+                pushed = std::min(pushed, residual[arc]);
+            size_t saturated = path.size();
+            for (size_t i = 0; i < path.size(); ++i) {
+                residual[path[i]] -= pushed;
+                residual[network.get_reverse(path[i])] += pushed;
+                if (residual[path[i]] == 0 && saturated == path.size())
+                    saturated = i;
+            }
+            flow += pushed;
+            path.resize(saturated);                             // Continue from the first saturated arc.
+            port = saturated == 0 ? source : network.get_target(path.back());
+            continue;
+        }
+
+        uint32_t& arc = current[port];
+        for (; arc < network.end(port); ++arc) {
+            if (residual[arc] > 0 && level[network.get_target(arc)] == level[port] + 1) break;
+        }
+        if (arc < network.end(port)) {                          // Advance.
+            path.push_back(arc);
+            port = network.get_target(arc);
+        }else if (port == source) {                             // Source is blocked, the phase is done.
+            return flow;
+        }else {                                                 // Dead end, retreat and never come back.
+            level[port] = -1;
+            path.pop_back();
+            port = path.empty() ? source : network.get_target(path.back());
+            ++current[port];
+        }
+    }
+}
+
+long long MaxFlow::max_flow(const FlowNetwork& network, const uint32_t source, const uint32_t target) {
+    const size_t ports = network.port_count();
+    residual = network.get_capacities();                        // Same size every query, no allocation.
+    level.resize(ports);
+    current.resize(ports);
+    if (source == target) {
+        std::fill(level.begin(), level.end(), -1);
+        return 0;
+    }
+
+    long long flow = 0;
+    while (build_levels(network, source, target))
+        flow += blocking_flow(network, source, target);
+    return flow;
+}
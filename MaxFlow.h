@@ -0,0 +1,40 @@
+#ifndef MAXFLOW_H
+#define MAXFLOW_H
+
+#include <cstdint>
+#include <vector>
+#include "FlowNetwork.h"
+
+/**
+ *  MaxFlow class
+ *  This class finds the maximum container flow between 2 ports of a flow network. (Dinic)
+ *  Every phase builds the levels of the residual network by a breadth first search from the source,
+ *  And then pushes a blocking flow along level increasing paths, by an iterative depth first search
+ *  that keeps the next arc to try of every port, so an arc that cannot push anymore is not scanned again in the phase.
+ *  After a query the ports that the source still reaches are its side of a minimum cut. (the bottleneck)
+ *  The residual, level and search buffers are kept between queries and only grow with the network,
+ *  So repeated queries do not allocate. A thread needs its own MaxFlow.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers,
+ *  the compiler-generated versions are enough.
+ ***/
+class MaxFlow {
+    std::vector<long long> residual;    // Capacity left on every arc.
+    std::vector<int> level;             // Breadth first search level of every port, -1 if not reached.
+    std::vector<uint32_t> current;      // Next arc to try of every port, in this phase.
+    std::vector<uint32_t> queue;        // Breadth first search queue.
+    std::vector<uint32_t> path;         // Arcs of the depth first search path.
+
+    bool build_levels(const FlowNetwork& network, uint32_t source, uint32_t target);   // False if target is cut off.
+    long long blocking_flow(const FlowNetwork& network, uint32_t source, uint32_t target);
+
+public:
+    // Returns the maximum flow from source to target, 0 if they are the same port.
+    long long max_flow(const FlowNetwork& network, uint32_t source, uint32_t target);
+
+    // True if port is on the source side of the minimum cut of the last query.
+    bool on_source_side(const uint32_t port) const { return level[port] >= 0; }
+};
+
+#endif //MAXFLOW_H
@@ -3,33 +3,45 @@
 
 #include <vector>
 #include "Edge.h"
+#include "Timeline.h"
 
 /**
- *  Generic Node class
- *  This class represents a Node, each Node contains two vectors of edges, and a source.
+ *  Node class
+ *  This class represents a Node (port), each Node contains two vectors of edges.
  *  The First vector represents all edges in the container graph,
  *  the Second vector represents all edges in the timing graph.
+ *  Each graph also keeps an inbound vector (reverse adjacency), where every edge points back to the port
+ *  it came from, so inbound queries only cost the in-degree of the port.
+ *  The timeline holds every container arrival and departure of the port, used by balance queries.
+ *  The name of the port is not stored here, Nodes are indexed by their interned port id.
  *
  *  The big 3:
  *  Not implemented because this class only contains standard containers and value types.
- *  The vectors and source are automatically managed, and there is no manual memory handling.
+ *  The vectors are automatically managed, and there is no manual memory handling.
  *  As a result, the compiler-generated versions are enough.
  ***/
-template<typename T>
 class Node {
-    T source;                               // Name of each Node.
-    std::vector<Edge<T>> container_edges;   // All edges from the current node to others in the container graph.
-    std::vector<Edge<T>> timing_edges;      //  ''   ''   ''   ''    ''    ''  ''   ''   ''  '' timing graph.
+    std::vector<Edge> container_edges;      // All edges from the current node to others in the container graph.
+    std::vector<Edge> timing_edges;         //  ''   ''   ''   ''    ''    ''  ''   ''   ''  '' timing graph.
+    std::vector<Edge> inbound_container_edges;      // All edges from other nodes to the current node in the container graph.
+    std::vector<Edge> inbound_timing_edges;         //  ''   ''   ''   ''    ''    ''  ''   ''   ''  ''   '' timing graph.
+    Timeline timeline;                              // Container events of the port, sorted by time.
 
 public:
-    explicit Node(const T& src) : source(std::move(src)) {}                             // Default ctor.
-    const T& get_source() const { return source; }                                      // Source getter.
+    std::vector<Edge>& get_container_edges() { return container_edges; }                // Read/Write.
+    const std::vector<Edge>& get_container_edges() const { return container_edges; }    // Container graph getter.
 
-    std::vector<Edge<T>>& get_container_edges() { return container_edges; }             // Read/Write.
-    const std::vector<Edge<T>>& get_container_edges() const { return container_edges; } // Container graph getter.
+    std::vector<Edge>& get_timing_edges() { return timing_edges; }                      // Read/Write.
+    const std::vector<Edge>& get_timing_edges() const { return timing_edges; }          // Timing graph getter.
 
-    std::vector<Edge<T>>& get_timing_edges() { return timing_edges; }                   // Read/Write.
-    const std::vector<Edge<T>>& get_timing_edges() const { return timing_edges; }       // Timing graph getter.
+    std::vector<Edge>& get_inbound_container_edges() { return inbound_container_edges; }             // Read/Write.
+    const std::vector<Edge>& get_inbound_container_edges() const { return inbound_container_edges; } // Inbound container getter.
+
+    std::vector<Edge>& get_inbound_timing_edges() { return inbound_timing_edges; }                   // Read/Write.
+    const std::vector<Edge>& get_inbound_timing_edges() const { return inbound_timing_edges; }       // Inbound timing getter.
+
+    Timeline& get_timeline() { return timeline; }                                       // Read/Write.
+    const Timeline& get_timeline() const { return timeline; }                           // Timeline getter.
 };
 
-#endif //NODE_H
\ No newline at end of file
+#endif //NODE_H
@@ -0,0 +1,66 @@
+#include "OutputWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Writes all chunks in order, (none of them empty) resumes after a partial writev, false on any error.
+static bool write_all(const int fd, std::vector<iovec>& chunks) {
+    size_t first = 0;
+    while (first < chunks.size()) {
+        const ssize_t written = writev(fd, chunks.data() + first, static_cast<int>(chunks.size() - first));
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        size_t left = static_cast<size_t>(written);
+        for (; first < chunks.size() && left >= chunks[first].iov_len; ++first)
+            left -= chunks[first].iov_len;
+        if (left > 0) {                         // Only the start of chunks[first] was written.
+            chunks[first].iov_base = static_cast<char*>(chunks[first].iov_base) + left;
+            chunks[first].iov_len -= left;
+        }
+    }
+    return true;
+}
+
+OutputWriter::OutputWriter(const unsigned _workers) : workers(_workers) {
+    if (workers == 0) workers = std::thread::hardware_concurrency();
+    if (workers == 0) workers = 1;
+}
+
+bool OutputWriter::write(const std::string& file_name, const size_t count, const Format& format) const {
+    const int fd = open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    const size_t shards = (count + OUTPUT_SHARD_ITEMS - 1) / OUTPUT_SHARD_ITEMS;
+    std::vector<std::string> buffers(std::min<size_t>(shards, OUTPUT_ROUND_SHARDS));  // Reused by every round.
+    std::vector<iovec> chunks;
+    bool written = true;
+    for (size_t round = 0; round < shards && written; round += buffers.size()) {
+        const size_t round_shards = std::min(buffers.size(), shards - round);
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t s = next++; s < round_shards; s = next++) {
+                const size_t first = (round + s) * OUTPUT_SHARD_ITEMS;
+                buffers[s].clear();
+                format(first, std::min<size_t>(count, first + OUTPUT_SHARD_ITEMS), buffers[s]);
+            }
+        };
+        const size_t count_workers = std::min<size_t>(workers, round_shards);
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < count_workers; ++t)
+            threads.emplace_back(worker);
+        worker();                               // The calling thread works too.
+        for (auto& thread : threads)
+            thread.join();
+
+        chunks.clear();
+        for (size_t s = 0; s < round_shards; ++s)
+            if (!buffers[s].empty()) chunks.push_back(iovec{const_cast<char*>(buffers[s].data()), buffers[s].size()});
+        written = write_all(fd, chunks);
+    }
+    return close(fd) == 0 && written;
+}
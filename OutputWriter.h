@@ -0,0 +1,36 @@
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#define OUTPUT_SHARD_ITEMS 256      // Items (ports) formatted by a worker at a time.
+#define OUTPUT_ROUND_SHARDS 128     // Shards formatted before they are written, bounds the memory. (<= IOV_MAX)
+
+/**
+ *  OutputWriter class
+ *  This class writes large text outputs (the print command) into a file.
+ *  The items are split into shards of OUTPUT_SHARD_ITEMS, the shards are formatted by a pool of worker threads,
+ *  Every shard into its own buffer, so the workers never share a buffer or a lock.
+ *  The buffers of a round of shards are then written in order by a single writev, (no formatting through
+ *  std::ofstream, and no syscall per line) so the file is the same as if the items were formatted one by one.
+ *
+ *  The big 3:
+ *  Not implemented because this class only holds the number of workers,
+ *  the compiler-generated versions are enough.
+ ***/
+class OutputWriter {
+    unsigned workers;           // Number of worker threads.
+
+public:
+    // Appends the text of items [first, last) to out, called by many threads at once.
+    using Format = std::function<void(size_t first, size_t last, std::string& out)>;
+
+    explicit OutputWriter(unsigned _workers = 0);   // 0 -> one worker per hardware thread.
+
+    // Writes the text of items [0, count) into file_name, (truncated) false if it cannot be opened or written.
+    bool write(const std::string& file_name, size_t count, const Format& format) const;
+};
+
+#endif //OUTPUTWRITER_H
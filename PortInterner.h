@@ -0,0 +1,62 @@
+#ifndef PORTINTERNER_H
+#define PORTINTERNER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#define NO_PORT UINT32_MAX  // Returned by find() for ports that were never interned.
+
+/**
+ *  Generic PortInterner class
+ *  This class maps every port name to a dense id (0, 1, 2 ...) in order of first appearance,
+ *  And back from an id to its name.
+ *  The graphs only store these ids, names are compared once (when interned / searched)
+ *  and resolved again only when printing.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers,
+ *  the compiler-generated versions are enough.
+ ***/
+template<typename T>
+class PortInterner {
+    std::unordered_map<T, uint32_t> ids;    // Port name -> id.
+    std::vector<T> names;                   // Id -> port name.
+    mutable std::vector<uint32_t> order;    // Ids sorted by name, of the first order.size() ports.
+
+public:
+    // Returns the id of name, a new id is given to names seen for the first time.
+    uint32_t intern(const T& name) {
+        const auto found = ids.find(name);
+        if (found != ids.end()) return found->second;
+        const uint32_t id = static_cast<uint32_t>(names.size());
+        ids.emplace(name, id);
+        names.push_back(name);
+        return id;
+    }
+
+    // Returns the id of name, or NO_PORT if name was never interned.
+    uint32_t find(const T& name) const {
+        const auto found = ids.find(name);
+        return found == ids.end() ? NO_PORT : found->second;
+    }
+
+    // Returns all ids sorted by name, ports interned since the last call are merged into the previous order.
+    const std::vector<uint32_t>& sorted() const {
+        const size_t known = order.size();
+        if (known == names.size()) return order;
+        for (size_t id = known; id < names.size(); ++id)
+            order.push_back(static_cast<uint32_t>(id));
+
+        const auto by_name = [this](const uint32_t a, const uint32_t b) { return names[a] < names[b]; };
+        std::sort(order.begin() + known, order.end(), by_name);
+        std::inplace_merge(order.begin(), order.begin() + known, order.end(), by_name);
+        return order;
+    }
+
+    const T& name(const uint32_t id) const { return names[id]; }     // Name getter.
+    size_t size() const { return names.size(); }                    // Number of ports.
+};
+
+#endif //PORTINTERNER_H
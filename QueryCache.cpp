@@ -0,0 +1,41 @@
+#include "QueryCache.h"
+
+const std::vector<ResultWriter::Result>* QueryCache::find(const std::string& key, const uint64_t generation) {
+    const auto found = index.find(key);
+    if (found == index.end()) {
+        ++misses;
+        return nullptr;
+    }
+    if (found->second->generation != generation) {         // Computed before the last change.
+        entries.erase(found->second);
+        index.erase(found);
+        ++misses;
+        return nullptr;
+    }
+    entries.splice(entries.begin(), entries, found->second);   // Most recently used.
+    ++hits;
+    return &entries.front().results;
+}
+
+void QueryCache::insert(const std::string& key, const uint64_t generation, std::vector<ResultWriter::Result> results) {
+    if (capacity == 0) return;
+    const auto found = index.find(key);
+    if (found != index.end()) {
+        entries.erase(found->second);
+        index.erase(found);
+    }
+    while (entries.size() >= capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front(Entry{key, generation, std::move(results)});
+    index[key] = entries.begin();
+}
+
+void QueryCache::set_capacity(const size_t _capacity) {
+    capacity = _capacity;
+    while (entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
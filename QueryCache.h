@@ -0,0 +1,57 @@
+#ifndef QUERYCACHE_H
+#define QUERYCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ResultWriter.h"
+
+#define QUERY_CACHE_SIZE 1024   // Default number of cached query results.
+
+/**
+ *  QueryCache class
+ *  This class keeps the results of the latest queries (least recently used are evicted first),
+ *  So a query repeated between loads is answered by replaying its results instead of running it again.
+ *  Every entry is tagged with the generation of the Graph it was computed on, the Graph bumps its generation
+ *  on every change, so an entry of an older generation is stale and is dropped when it is found.
+ *  Hits and misses are counted, to tune the capacity.
+ *
+ *  The big 3:
+ *  Copy constructor and assignment operator are deleted, the iterators in index point into entries
+ *  of the same object, so a copy would point into the original. The default destructor is enough.
+ ***/
+class QueryCache {
+    struct Entry {
+        std::string key;                            // The query.
+        uint64_t generation;                        // Generation of the Graph the results belong to.
+        std::vector<ResultWriter::Result> results;  // Everything the query wrote.
+    };
+
+    size_t capacity;                                                        // Maximum number of entries.
+    std::list<Entry> entries;                                               // Most recently used first.
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;      // Query -> its entry.
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+public:
+    explicit QueryCache(size_t _capacity = QUERY_CACHE_SIZE) : capacity(_capacity) {}
+
+    QueryCache(const QueryCache&) = delete;
+    QueryCache& operator=(const QueryCache&) = delete;
+
+    // Returns the results of key computed on generation, or nullptr (a miss) if there are none.
+    const std::vector<ResultWriter::Result>* find(const std::string& key, uint64_t generation);
+
+    // Stores the results of key computed on generation, evicts the least recently used entry if full.
+    void insert(const std::string& key, uint64_t generation, std::vector<ResultWriter::Result> results);
+
+    void set_capacity(size_t _capacity);                            // Capacity setter, 0 disables the cache.
+    size_t get_capacity() const { return capacity; }                // Capacity getter.
+    size_t size() const { return entries.size(); }                  // Number of entries.
+    uint64_t get_hits() const { return hits; }                      // Hits getter.
+    uint64_t get_misses() const { return misses; }                  // Misses getter.
+};
+
+#endif //QUERYCACHE_H
@@ -0,0 +1,124 @@
+#include "ResultWriter.h"
+
+// Appends text as a quoted JSON string.
+static void append_json(std::string& json, const std::string& text) {
+    static const char* const HEX = "0123456789abcdef";
+    json += '"';
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            json += '\\';
+            json += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            json += "\\u00";
+            json += HEX[(c >> 4) & 0xF];
+            json += HEX[c & 0xF];
+        } else {
+            json += c;
+        }
+    }
+    json += '"';
+}
+
+ResultWriter::ResultWriter(std::ostream& _out, const Format _format, const size_t _buffer_size,
+                           std::ostream* const _errors)
+: out(_out), errors(_errors), format(_format), buffer_size(_buffer_size) {}
+
+void ResultWriter::begin(const std::string& _command) {
+    command = _command;
+    rows.clear();
+    messages.clear();
+    value.clear();
+    error_list.clear();
+}
+
+void ResultWriter::row(const std::string& name, const long long number) {
+    if (recording) recording->push_back(Result{Result::ROW, name, number});
+    if (format == Format::TEXT) {
+        buffer += name;
+        buffer += ',';
+        buffer += std::to_string(number);
+        buffer += '\n';
+        written();
+        return;
+    }
+    rows += rows.empty() ? "[" : ",[";
+    append_json(rows, name);
+    rows += ',';
+    rows += std::to_string(number);
+    rows += ']';
+}
+
+void ResultWriter::number(const long long number) {
+    if (recording) recording->push_back(Result{Result::NUMBER, std::string(), number});
+    if (format == Format::TEXT) {
+        buffer += std::to_string(number);
+        buffer += '\n';
+        written();
+        return;
+    }
+    value = std::to_string(number);
+}
+
+void ResultWriter::message(const std::string& text) {
+    if (recording) recording->push_back(Result{Result::MESSAGE, text, 0});
+    if (format == Format::TEXT) {
+        buffer += text;
+        buffer += '\n';
+        written();
+        return;
+    }
+    if (!messages.empty()) messages += ',';
+    append_json(messages, text);
+}
+
+void ResultWriter::error(const std::string& text) {
+    if (errors) {
+        *errors << text;
+        return;
+    }
+    if (format == Format::TEXT) {
+        buffer += text;
+        written();
+        return;
+    }
+    if (!error_list.empty()) error_list += ',';
+    append_json(error_list, text.size() > 0 && text.back() == '\n' ? text.substr(0, text.size() - 1) : text);
+}
+
+void ResultWriter::end() {
+    if (format == Format::JSON_LINES) {
+        buffer += "{\"command\":";
+        append_json(buffer, command);
+        if (!rows.empty()) buffer += ",\"rows\":[" + rows + "]";
+        if (!value.empty()) buffer += ",\"value\":" + value;
+        if (!messages.empty()) buffer += ",\"messages\":[" + messages + "]";
+        if (!error_list.empty()) buffer += ",\"errors\":[" + error_list + "]";
+        buffer += "}\n";
+    }
+    written();
+}
+
+void ResultWriter::record(std::vector<Result>* results) {
+    recording = results;
+}
+
+void ResultWriter::replay(const std::vector<Result>& results) {
+    for (const auto& result : results) {
+        switch (result.kind) {
+            case Result::ROW: row(result.text, result.number); break;
+            case Result::NUMBER: number(result.number); break;
+            case Result::MESSAGE: message(result.text); break;
+        }
+    }
+}
+
+void ResultWriter::written() {
+    if (buffer.size() >= buffer_size)
+        flush();
+}
+
+void ResultWriter::flush() {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.flush();
+    buffer.clear();
+}
@@ -0,0 +1,69 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ *  ResultWriter class
+ *  Every query result goes through this class instead of straight to std::cout.
+ *  The results are collected in a large buffer, written only when the buffer is full (batch mode) or after
+ *  every line (interactive mode), so a script of many queries does not pay a syscall per result line.
+ *  Two formats are supported:
+ *   - TEXT: the exact lines the terminal always printed, (name,value / value / message)
+ *   - JSON_LINES: a single JSON object per command, for example
+ *     {"command":"Haifa,outbound","rows":[["Ashdod",1440]]}
+ *  Errors are not results, they are printed into std::cerr, (unbuffered) or, for a writer without an error
+ *  stream (a server client, see Terminal::session), written with the results in order: the same text lines (TEXT),
+ *  or an "errors" list of the command's object (JSON_LINES), so the client that sent the command gets them back.
+ *
+ *  The big 3:
+ *  Not implemented because this class only holds a reference to the stream and standard strings,
+ *  the destructor of the owner must call flush(), the compiler-generated versions are enough.
+ ***/
+class ResultWriter {
+public:
+    enum class Format { TEXT, JSON_LINES };
+
+    // A single result, recorded so it can be written again later. (see QueryCache)
+    struct Result {
+        enum Kind { ROW, NUMBER, MESSAGE } kind;
+        std::string text;       // Name of a row, or the message.
+        long long number;       // Value of a row, or the number.
+    };
+
+private:
+    std::ostream& out;          // Where the results go.
+    std::ostream* errors;       // Where the errors go, nullptr -> with the results.
+    Format format;              // Output format.
+    size_t buffer_size;         // Flush when the buffer is larger, 0 -> flush after every line.
+    std::string buffer;         // Results not written yet.
+
+    std::string command;        // JSON_LINES: the command of the current record,
+    std::string rows;           //  ''  its rows,
+    std::string messages;       //  ''  its messages,
+    std::string value;          //  ''  its single value.
+    std::string error_list;     //  ''  its errors.
+
+    std::vector<Result>* recording = nullptr;   // Every result is also appended here, if set.
+
+    void written();             // Flushes if the buffer is full.
+
+public:
+    explicit ResultWriter(std::ostream& _out, Format _format = Format::TEXT, size_t _buffer_size = 0,
+                          std::ostream* _errors = &std::cerr);
+
+    void begin(const std::string& _command);                // Starts the results of a command.
+    void row(const std::string& name, long long number);    // A name,value result line.
+    void number(long long number);                          // A single value result.
+    void message(const std::string& text);                  // A message line.
+    void error(const std::string& text);                    // An error, text ends with a new line. (not recorded)
+    void end();                                             // Ends the results of the current command.
+
+    void record(std::vector<Result>* results);              // Records all following results, nullptr stops.
+    void replay(const std::vector<Result>& results);        // Writes recorded results again.
+    void flush();                                           // Writes everything buffered so far.
+};
+
+#endif //RESULTWRITER_H
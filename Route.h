@@ -0,0 +1,56 @@
+#ifndef ROUTE_H
+#define ROUTE_H
+
+#include <cstdint>
+
+/**
+ *  Route class
+ *  This class represents the aggregate of a single timing edge (source -> destination),
+ *  The Graph keeps one Route per (source, destination) pair in a hash map, so finding and updating an
+ *  existing route when a new sail is loaded is O(1) expected, no matter how many routes leave the source.
+ *  Holds the position of the edge in both adjacency vectors, and the sum and count of the timings of every sail
+ *  on the route, so the weight is their exact (integer) mean, and a sail can be taken out again. (see Graph::unload)
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains value types,
+ *  the compiler-generated versions are enough.
+ ***/
+class Route {
+    uint32_t edge;              // Index of the edge in the source's timing edges.
+    uint32_t inbound_edge;      // Index of the edge in the destination's inbound timing edges.
+    long long sum;              // Sum of the timings of all sails from A to B.
+    int count;                  // Number of sails from A to B.
+
+public:
+    explicit Route(const uint32_t _edge, const uint32_t _inbound_edge, const long long _sum, const int _count = 1)
+    : edge(_edge), inbound_edge(_inbound_edge), sum(_sum), count(_count) {}
+
+    // Adds the timings of a sail, returns the new weight.
+    int add_timings(const int timings) {
+        sum += timings;
+        ++count;
+        return get_weight();
+    }
+
+    // Takes out the timings of a sail added before, returns the new weight. (0 once no sail is left)
+    int remove_timings(const int timings) {
+        sum -= timings;
+        --count;
+        return get_weight();
+    }
+
+    uint32_t get_edge() const { return edge; }                      // Edge index getter.
+    uint32_t get_inbound_edge() const { return inbound_edge; }      // Inbound edge index getter.
+    void set_edge(const uint32_t _edge) { edge = _edge; }                           // Edge index setter. (compaction)
+    void set_inbound_edge(const uint32_t _edge) { inbound_edge = _edge; }           // Inbound edge index setter.
+    long long get_sum() const { return sum; }                       // Sum of timings getter.
+    int get_count() const { return count; }                         // Number of sails getter.
+    int get_weight() const { return count == 0 ? 0 : static_cast<int>(sum / count); }  // Mean timings.
+
+    // Key of the route inside the Graph's route map.
+    static uint64_t key(const uint32_t source, const uint32_t destination) {
+        return static_cast<uint64_t>(source) << 32 | destination;
+    }
+};
+
+#endif //ROUTE_H
@@ -0,0 +1,57 @@
+#include "RoutePlanner.h"
+#include <algorithm>
+#include <functional>
+
+void RoutePlanner::reach(const uint32_t port, const long long port_distance, const uint32_t from) {
+    if (stamp[port] != generation) {                 // First time this query reaches port.
+        stamp[port] = generation;
+        visited[port] = 0;
+    }else if (visited[port] || distance[port] <= port_distance) {
+        return;
+    }
+    distance[port] = port_distance;
+    previous[port] = from;
+    heap.emplace_back(port_distance, port);
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+long long RoutePlanner::shortest_path(const CsrGraph& graph, const uint32_t source, const uint32_t target,
+                                      std::vector<uint32_t>& path) {
+    path.clear();
+    const size_t ports = graph.port_count();
+    if (source >= ports || target >= ports) return -1;
+
+    if (stamp.size() < ports) {                     // The graph grew, new ports are unreached.
+        distance.resize(ports);
+        previous.resize(ports);
+        visited.resize(ports);
+        stamp.resize(ports, generation);            // Older than the generation of this query.
+    }
+    if (++generation == 0) {                        // Wrapped around, every stamp is old again.
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+    heap.clear();
+
+    reach(source, 0, source);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        const HeapEntry top = heap.back();
+        heap.pop_back();
+
+        const uint32_t port = top.second;
+        if (visited[port]) continue;                // Stale entry, port was settled with a smaller distance.
+        visited[port] = 1;
+        if (port == target) break;
+
+        for (uint32_t e = graph.begin(port); e < graph.end(port); ++e)
+            reach(graph.get_target(e), top.first + graph.get_weight(e), port);
+    }
+    if (stamp[target] != generation || !visited[target]) return -1;
+
+    for (uint32_t port = target; port != source; port = previous[port])
+        path.push_back(port);
+    path.push_back(source);
+    std::reverse(path.begin(), path.end());
+    return distance[target];
+}
@@ -0,0 +1,42 @@
+#ifndef ROUTEPLANNER_H
+#define ROUTEPLANNER_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "CsrGraph.h"
+
+/**
+ *  RoutePlanner class
+ *  This class finds the fastest route between 2 ports of a compiled timing graph, (Dijkstra with a binary heap)
+ *  The weight of every timing edge is the averaged sailing minutes of that hop.
+ *  The distance, previous port and heap buffers are kept between queries and only grow with the graph,
+ *  A port is reset lazily by a generation stamp, so a query touches (and clears) only the ports it reaches,
+ *  And repeated queries do not allocate. A thread needs its own planner.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers and value types,
+ *  the compiler-generated versions are enough.
+ ***/
+class RoutePlanner {
+    using HeapEntry = std::pair<long long, uint32_t>;  // (distance, port), smallest distance on top.
+
+    std::vector<long long> distance;    // Best distance found so far to every port, valid if stamp == generation.
+    std::vector<uint32_t> previous;     // Port before every port on its best route.
+    std::vector<uint32_t> stamp;        // Generation of the last query that reached every port.
+    std::vector<uint8_t> visited;       // Settled ports, valid if stamp == generation.
+    std::vector<HeapEntry> heap;        // Ports to visit.
+    uint32_t generation = 0;            // Current query.
+
+    void reach(uint32_t port, long long port_distance, uint32_t from);     // Relaxes port.
+
+public:
+    // Finds the fastest route from source to target, fills path (source first, target last),
+    // Returns the total minutes, or -1 if target is not reachable from source.
+    long long shortest_path(const CsrGraph& graph, uint32_t source, uint32_t target, std::vector<uint32_t>& path);
+
+    // Minutes from the source of the last query to port on the route, (any port of the last path)
+    long long distance_to(const uint32_t port) const { return distance[port]; }
+};
+
+#endif //ROUTEPLANNER_H
@@ -1,12 +1,9 @@
 #include "SailDetails.h"
-#include <ctime>
-#include "Utils.h"
-int SailDetails::uniqueID = 0;
 
-SailDetails::SailDetails(std::string _departure) :departure(std::move(_departure)){}
+SailDetails::SailDetails(const TimeStamp _departure) :departure(_departure){}
 
-SailDetails::SailDetails(const int _containers, const int _timings, std::string _departure, std::string _destination)
-: timings(_timings),containers(_containers), departure(std::move(_departure)), destination(std::move(_destination)) {}
+SailDetails::SailDetails(const int _containers, const int _timings, const TimeStamp _departure, std::string _destination)
+: timings(_timings),containers(_containers), departure(_departure), destination(std::move(_destination)) {}
 
 SailDetails::SailDetails(const SailDetails& other) {
     timings = other.timings;
@@ -18,7 +15,7 @@ SailDetails::SailDetails(const SailDetails& other) {
 SailDetails::SailDetails(SailDetails&& other) noexcept {
     timings = other.timings;
     containers = other.containers;
-    departure = std::move(other.departure);
+    departure = other.departure;
     destination = std::move(other.destination);
 }
 
@@ -33,25 +30,11 @@ SailDetails& SailDetails::operator=(const SailDetails& other) {
 }
 
 bool SailDetails::operator<=(const SailDetails& other) const {
-    std::tm tm1 = datetime(departure);
-    std::tm tm2 = datetime(other.get_departure());
-    const std::time_t time1 = std::mktime(&tm1);
-    const std::time_t time2 = std::mktime(&tm2);
-    return time1 <= time2;
+    return departure <= other.departure;
 }
 
-
 bool SailDetails::operator==(const SailDetails& other) const {
-    std::tm tm1 = datetime(departure);
-    std::tm tm2 = datetime(other.get_departure());
-    const std::time_t time1 = std::mktime(&tm1);
-    const std::time_t time2 = std::mktime(&tm2);
-    return time1 == time2;
-}
-
-void SailDetails::set_avg_timings(const int _timings) {
-    ++avg;
-    this->timings = (this->timings + _timings) / avg;
+    return departure == other.departure;
 }
 
 int SailDetails::get_timings() const {
@@ -62,13 +45,10 @@ int SailDetails::get_containers() const {
     return containers;
 }
 
-const std::string& SailDetails::get_departure() const {
+const TimeStamp& SailDetails::get_departure() const {
     return departure;
 }
 
 const std::string& SailDetails::get_destination() const {
     return destination;
 }
-void SailDetails::next_unique_id() {
-    ++uniqueID;
-}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define SAILDETAILS_H
 
 #include <string>
+#include "TimeStamp.h"
 
 /**
  *  SailDetails class
@@ -17,16 +18,13 @@
 class SailDetails {
     int timings{};              // Time in minutes taken from A to arrive to B.
     int containers{};           // Number of containers traveled in route.
-    std::string departure;      // Departure time.
+    TimeStamp departure;        // Departure time.
     std::string destination;    // Destination.
-    int avg = 1;                // Used for averaging the timings from A to B. (number of times routes updated)
 
 public:
-    static int uniqueID;        // Unique id that's provided to each edge in the graph.
-
     explicit SailDetails() = default;                           // ctor's
-    explicit SailDetails(std::string _departure);
-    explicit SailDetails(int _containers, int _timings, std::string _departure, std::string _destination);
+    explicit SailDetails(TimeStamp _departure);
+    explicit SailDetails(int _containers, int _timings, TimeStamp _departure, std::string _destination);
 
     SailDetails(const SailDetails& other);                      // Copy ctor.
     SailDetails(SailDetails&& other) noexcept;                  // Move ctor.
@@ -35,14 +33,12 @@ public:
 
     bool operator==(const SailDetails& other) const;     // Check if current departure == other.departure.
     bool operator<=(const SailDetails& other) const;     // Check if current departure <= other.departure.
-    void set_avg_timings(int _timings);                  // Updates the timing field by averaging current with other
 
     int get_timings() const;                             // All fields getters.
     int get_containers() const;
-    const std::string& get_departure() const;
+    const TimeStamp& get_departure() const;
     const std::string& get_destination() const;
 
-    static void next_unique_id();
     ~SailDetails() = default;
 };
 #endif //SAILDETAILS_H
\ No newline at end of file
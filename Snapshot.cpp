@@ -0,0 +1,351 @@
+#include "Snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "FileException.h"
+#include "MappedFile.h"
+
+#define SNAPSHOT_ALIGNMENT 8
+
+// The fixed size records of the file.
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t payload_size;
+    uint64_t checksum;
+};
+
+struct SnapshotEdge {
+    uint32_t destination;
+    int32_t weight;
+    int32_t sail_id;
+};
+
+struct SnapshotEvent {
+    int32_t minutes;
+    int32_t delta;
+};
+
+struct SnapshotLeg {
+    int32_t timings;
+    int32_t containers;
+    int32_t departure;
+    uint32_t destination;
+};
+
+struct SnapshotRoute {
+    uint64_t key;
+    uint32_t edge;
+    uint32_t inbound_edge;
+    int64_t sum;
+    int32_t count;
+    int32_t padding;
+};
+
+// Appends values to the payload, keeping every section aligned.
+class SnapshotWriter {
+    std::vector<char> bytes;
+
+public:
+    template<typename V>
+    void put(const V& value) {
+        const char* raw = reinterpret_cast<const char*>(&value);
+        bytes.insert(bytes.end(), raw, raw + sizeof(V));
+    }
+
+    template<typename V>
+    void put_array(const std::vector<V>& values) {
+        const char* raw = reinterpret_cast<const char*>(values.data());
+        bytes.insert(bytes.end(), raw, raw + values.size() * sizeof(V));
+        align();
+    }
+
+    void align() {
+        bytes.resize((bytes.size() + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT, 0);
+    }
+
+    const std::vector<char>& get_bytes() const { return bytes; }
+};
+
+// Reads values back from the payload, every read is bounds checked.
+class SnapshotReader {
+    const char* position;
+    const char* begin;
+    const char* end;
+
+public:
+    SnapshotReader(const char* _begin, const char* _end) : position(_begin), begin(_begin), end(_end) {}
+
+    template<typename V>
+    bool get(V& value) {
+        if (static_cast<size_t>(end - position) < sizeof(V)) return false;
+        std::memcpy(&value, position, sizeof(V));
+        position += sizeof(V);
+        return true;
+    }
+
+    template<typename V>
+    bool get_array(std::vector<V>& values, const size_t count) {
+        if (static_cast<size_t>(end - position) / sizeof(V) < count) return false;
+        values.resize(count);
+        std::memcpy(values.data(), position, count * sizeof(V));
+        position += count * sizeof(V);
+        return align();
+    }
+
+    bool align() {
+        const size_t offset = (position - begin + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+        if (offset > static_cast<size_t>(end - begin)) return false;
+        position = begin + offset;
+        return true;
+    }
+
+    bool at_end() const { return position == end; }
+};
+
+// Writes the edges selected by list of every port, offsets first.
+static void put_edges(SnapshotWriter& writer, const std::vector<Node>& nodes, const CsrGraph::EdgeList list) {
+    std::vector<uint32_t> offsets(1, 0);
+    std::vector<SnapshotEdge> edges;
+    for (const auto& node : nodes) {
+        for (const auto& edge : (node.*list)())
+            edges.push_back(SnapshotEdge{edge.get_destination(), edge.get_weight(), edge.get_sail_id()});
+        offsets.push_back(static_cast<uint32_t>(edges.size()));
+    }
+    writer.put_array(offsets);
+    writer.put_array(edges);
+}
+
+// Reads per port offsets written by put_edges / timelines, checks that they only grow.
+static bool get_offsets(SnapshotReader& reader, std::vector<uint32_t>& offsets, const size_t ports) {
+    if (!reader.get_array(offsets, ports + 1) || offsets[0] != 0) return false;
+    return std::is_sorted(offsets.begin(), offsets.end());
+}
+
+// Reads the edges written by put_edges into the vectors selected by list.
+static bool get_edges(SnapshotReader& reader, std::vector<Node>& nodes, std::vector<Edge>& (Node::*list)()) {
+    std::vector<uint32_t> offsets;
+    std::vector<SnapshotEdge> edges;
+    if (!get_offsets(reader, offsets, nodes.size()) || !reader.get_array(edges, offsets.back())) return false;
+
+    for (size_t port = 0; port < nodes.size(); ++port) {
+        auto& target = (nodes[port].*list)();
+        target.reserve(offsets[port + 1] - offsets[port]);
+        for (uint32_t e = offsets[port]; e < offsets[port + 1]; ++e) {
+            if (edges[e].destination >= nodes.size() && edges[e].destination != REMOVED_EDGE) return false;
+            target.emplace_back(edges[e].destination, edges[e].weight, edges[e].sail_id);
+        }
+    }
+    return true;
+}
+
+void Snapshot::save(const Graph<std::string>& graph, const std::string& file_name) {
+    SnapshotWriter writer;
+
+    const uint32_t ports = static_cast<uint32_t>(graph.ports.size());
+    std::vector<uint32_t> name_offsets(1, 0);
+    std::vector<char> names;
+    for (uint32_t port = 0; port < ports; ++port) {
+        names.insert(names.end(), graph.ports.name(port).begin(), graph.ports.name(port).end());
+        name_offsets.push_back(static_cast<uint32_t>(names.size()));
+    }
+    writer.put(ports);
+    writer.align();
+    writer.put_array(name_offsets);
+    writer.put_array(names);
+
+    put_edges(writer, graph.dual_graph, &Node::get_container_edges);
+    put_edges(writer, graph.dual_graph, &Node::get_timing_edges);
+    put_edges(writer, graph.dual_graph, &Node::get_inbound_container_edges);
+    put_edges(writer, graph.dual_graph, &Node::get_inbound_timing_edges);
+
+    std::vector<uint32_t> event_offsets(1, 0);
+    std::vector<SnapshotEvent> events;
+    for (const auto& node : graph.dual_graph) {
+        for (const auto& event : node.get_timeline().get_events())
+            if (event.second != 0)                      // Removed events (tombstones) are not saved.
+                events.push_back(SnapshotEvent{event.first.get_minutes(), event.second});
+        event_offsets.push_back(static_cast<uint32_t>(events.size()));
+    }
+    writer.put_array(event_offsets);
+    writer.put_array(events);
+
+    const VoyageStore& voyages = graph.voyages;
+    std::vector<int32_t> sail_ids;
+    std::vector<uint32_t> leg_offsets(1, 0);
+    std::vector<SnapshotLeg> legs;
+    std::vector<uint8_t> removed;
+    for (size_t v = 0; v < voyages.size(); ++v) {
+        sail_ids.push_back(voyages.id(v));
+        removed.push_back(voyages.is_removed(v));
+        for (uint32_t leg = voyages.begin(v); leg < voyages.end(v); ++leg)
+            legs.push_back(SnapshotLeg{voyages.get_minutes(leg), voyages.get_containers(leg),
+                                       voyages.get_departure(leg).get_minutes(), voyages.get_port(leg)});
+        leg_offsets.push_back(static_cast<uint32_t>(legs.size()));
+    }
+    writer.put(static_cast<uint32_t>(sail_ids.size()));
+    writer.align();
+    writer.put_array(sail_ids);
+    writer.put_array(leg_offsets);
+    writer.put_array(legs);
+    writer.put_array(removed);
+
+    std::vector<SnapshotRoute> routes;
+    for (const auto& route : graph.routes)
+        routes.push_back(SnapshotRoute{route.first, route.second.get_edge(), route.second.get_inbound_edge(),
+                                       route.second.get_sum(), route.second.get_count(), 0});
+    writer.put(static_cast<uint32_t>(routes.size()));
+    writer.align();
+    writer.put_array(routes);
+
+    std::vector<uint32_t> file_offsets(1, 0), id_offsets(1, 0);
+    std::vector<char> file_names;
+    std::vector<int32_t> file_ids;
+    for (const auto& file : graph.files) {
+        file_names.insert(file_names.end(), file.first.begin(), file.first.end());
+        file_offsets.push_back(static_cast<uint32_t>(file_names.size()));
+        file_ids.insert(file_ids.end(), file.second.begin(), file.second.end());
+        id_offsets.push_back(static_cast<uint32_t>(file_ids.size()));
+    }
+    writer.put(static_cast<uint32_t>(graph.files.size()));
+    writer.align();
+    writer.put_array(file_offsets);
+    writer.put_array(file_names);
+    writer.put_array(id_offsets);
+    writer.put_array(file_ids);
+
+    writer.put(graph.next_id);                  // Of the same version as the voyages.
+    writer.align();
+
+    const auto& payload = writer.get_bytes();
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.header_size = sizeof(SnapshotHeader);
+    header.payload_size = payload.size();
+    header.checksum = checksum(payload.data(), payload.size());
+
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        throw FileNotFoundException(file_name);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!file)
+        throw FileNotFoundException(file_name);
+}
+
+void Snapshot::restore(Graph<std::string>& graph, const std::string& file_name) {
+    const MappedFile file(file_name);
+    if (!file.is_open())
+        throw FileNotFoundException(file_name);
+
+    SnapshotHeader header{};
+    const size_t size = file.end() - file.begin();
+    if (size < sizeof(header))
+        throw InvalidSnapshotException(file_name);
+    std::memcpy(&header, file.begin(), sizeof(header));
+    const char* payload = file.begin() + sizeof(header);
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION ||
+        header.header_size != sizeof(header) || header.payload_size != size - sizeof(header) ||
+        header.checksum != checksum(payload, header.payload_size))
+        throw InvalidSnapshotException(file_name);
+
+    Graph<std::string> restored;
+    SnapshotReader reader(payload, file.end());
+    bool valid = true;
+
+    uint32_t ports = 0;
+    std::vector<uint32_t> name_offsets;
+    std::vector<char> names;
+    valid = valid && reader.get(ports) && reader.align() && get_offsets(reader, name_offsets, ports) &&
+            reader.get_array(names, name_offsets.back());
+    for (uint32_t port = 0; valid && port < ports; ++port) {
+        const std::string name(names.data() + name_offsets[port], name_offsets[port + 1] - name_offsets[port]);
+        valid = restored.add_port(name) == port;        // Names must be unique, ids are given in order.
+    }
+
+    valid = valid && get_edges(reader, restored.dual_graph, &Node::get_container_edges);
+    valid = valid && get_edges(reader, restored.dual_graph, &Node::get_timing_edges);
+    valid = valid && get_edges(reader, restored.dual_graph, &Node::get_inbound_container_edges);
+    valid = valid && get_edges(reader, restored.dual_graph, &Node::get_inbound_timing_edges);
+    if (valid) restored.count_edges();
+
+    std::vector<uint32_t> event_offsets;
+    std::vector<SnapshotEvent> events;
+    valid = valid && get_offsets(reader, event_offsets, ports) && reader.get_array(events, event_offsets.back());
+    for (uint32_t port = 0; valid && port < ports; ++port) {
+        Timeline& timeline = restored.dual_graph[port].get_timeline();
+        for (uint32_t e = event_offsets[port]; e < event_offsets[port + 1]; ++e)
+            timeline.add_event(TimeStamp(events[e].minutes), events[e].delta);
+        timeline.commit();
+    }
+
+    uint32_t voyages = 0;
+    std::vector<int32_t> sail_ids;
+    std::vector<uint32_t> leg_offsets;
+    std::vector<SnapshotLeg> legs;
+    std::vector<uint8_t> removed;
+    valid = valid && reader.get(voyages) && reader.align() && reader.get_array(sail_ids, voyages) &&
+            get_offsets(reader, leg_offsets, voyages) && reader.get_array(legs, leg_offsets.back()) &&
+            reader.get_array(removed, voyages);
+    for (uint32_t v = 0; valid && v < voyages; ++v) {
+        valid = restored.voyages.begin_voyage(sail_ids[v]);        // Ids must be consecutive.
+        for (uint32_t l = leg_offsets[v]; valid && l < leg_offsets[v + 1]; ++l) {
+            valid = legs[l].destination < ports;
+            if (valid)
+                restored.voyages.add_leg(legs[l].destination, TimeStamp(legs[l].departure), legs[l].timings,
+                                         legs[l].containers);
+        }
+        if (valid && removed[v])
+            restored.voyages.remove(v);
+        else if (valid)
+            restored.count_traffic(v, 1);               // Derived, not saved.
+    }
+
+    uint32_t route_count = 0;
+    std::vector<SnapshotRoute> routes;
+    valid = valid && reader.get(route_count) && reader.align() && reader.get_array(routes, route_count);
+    for (uint32_t r = 0; valid && r < route_count; ++r) {
+        const uint32_t source = static_cast<uint32_t>(routes[r].key >> 32);
+        const uint32_t destination = static_cast<uint32_t>(routes[r].key);
+        valid = source < ports && destination < ports &&
+                routes[r].edge < restored.dual_graph[source].get_timing_edges().size() &&
+                routes[r].inbound_edge < restored.dual_graph[destination].get_inbound_timing_edges().size();
+        if (valid)
+            restored.routes.emplace(routes[r].key,
+                                    Route(routes[r].edge, routes[r].inbound_edge, routes[r].sum, routes[r].count));
+    }
+
+    uint32_t file_count = 0;
+    std::vector<uint32_t> file_offsets, id_offsets;
+    std::vector<char> file_names;
+    std::vector<int32_t> file_ids;
+    valid = valid && reader.get(file_count) && reader.align() && get_offsets(reader, file_offsets, file_count) &&
+            reader.get_array(file_names, file_offsets.back()) && get_offsets(reader, id_offsets, file_count) &&
+            reader.get_array(file_ids, id_offsets.back());
+    for (uint32_t f = 0; valid && f < file_count; ++f) {
+        const std::string name(file_names.data() + file_offsets[f], file_offsets[f + 1] - file_offsets[f]);
+        auto& ids = restored.files[name];
+        for (uint32_t i = id_offsets[f]; valid && i < id_offsets[f + 1]; ++i) {
+            const size_t v = restored.voyages.index(file_ids[i]);
+            valid = file_ids[i] >= restored.voyages.id(0) && v < restored.voyages.size() &&
+                    !restored.voyages.is_removed(v);        // Only voyages that are still loaded.
+            ids.push_back(file_ids[i]);
+        }
+    }
+
+    int32_t unique_id = 0;
+    valid = valid && reader.get(unique_id) && reader.align() && reader.at_end() &&
+            unique_id == restored.voyages.id(0) + static_cast<int32_t>(restored.voyages.size());   // The next voyage.
+    if (!valid)
+        throw InvalidSnapshotException(file_name);
+    // The history stays open, (see below) a restored voyage that is also in it would be counted twice.
+    if (graph.history && restored.overlaps(*graph.history))
+        throw HistoryOverlapException(file_name);
+
+    restored.generation = graph.generation + 1;     // Results cached before the restore are stale.
+    restored.history = graph.history;               // Not part of the network, opened separately.
+    restored.next_id = unique_id;
+    graph = std::move(restored);
+}
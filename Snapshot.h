@@ -0,0 +1,43 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include "Graph.h"
+
+#define SNAPSHOT_MAGIC "CARGOSNP"
+#define SNAPSHOT_VERSION 2
+
+/**
+ *  Snapshot class
+ *  Saves the whole network (ports, both edge sets and their inbound copies, timelines, route aggregates,
+ *  voyage legs, the sail_ids of every loaded file and the next sail_id) into a single binary file, and restores it.
+ *  Restoring is a single sequential read of a mapped file, instead of parsing and validating every input file again.
+ *  The traffic rankings are not saved, they are counted again from the restored voyages.
+ *
+ *  File format (native byte order), every section starts at an 8 byte boundary so it can be used in place:
+ *   - header: magic, version, payload size, and an FNV-1a checksum of the payload,
+ *   - port names: count, offsets, characters,
+ *   - container, timing, inbound container and inbound timing edges: per port offsets, then (destination, weight, sail_id),
+ *     removed edges are kept, (destination REMOVED_EDGE) so the edge indexes of the routes stay valid,
+ *   - timelines: per port offsets, then (minutes, delta),
+ *   - voyages: count, sail ids, per voyage leg offsets, then (timings, containers, departure, destination port),
+ *     then a removed flag per voyage,
+ *   - routes: count, then (key, edge, inbound edge, sum of timings, count of sails),
+ *   - files: count, name offsets, characters, per file sail_id offsets, then the sail_ids,
+ *   - the next sail_id, it must follow the last voyage.
+ *
+ *  The big 3:
+ *  Not implemented because this class has no state, only static functions.
+ ***/
+class Snapshot {
+public:
+    // Writes graph into file_name, throws FileNotFoundException if the file cannot be written.
+    static void save(const Graph<std::string>& graph, const std::string& file_name);
+
+    // Replaces graph with the contents of file_name, throws FileNotFoundException if the file cannot be read,
+    // InvalidSnapshotException if it is not a valid snapshot. graph is not changed if an exception is thrown.
+    // The history of graph is kept, it is not part of the snapshot. (see VoyageArchive)
+    static void restore(Graph<std::string>& graph, const std::string& file_name);
+};
+
+#endif //SNAPSHOT_H
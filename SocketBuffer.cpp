@@ -0,0 +1,34 @@
+#include "SocketBuffer.h"
+#include <cerrno>
+#include <sys/socket.h>
+
+SocketBuffer::SocketBuffer(const int _socket) : socket(_socket) {
+    setg(input, input, input);
+}
+
+SocketBuffer::int_type SocketBuffer::underflow() {
+    ssize_t received;
+    do {
+        received = recv(socket, input, sizeof(input), 0);
+    } while (received < 0 && errno == EINTR);
+    if (received <= 0) return traits_type::eof();
+    setg(input, input, input + received);
+    return traits_type::to_int_type(input[0]);
+}
+
+SocketBuffer::int_type SocketBuffer::overflow(const int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    const char character = traits_type::to_char_type(c);
+    return xsputn(&character, 1) == 1 ? c : traits_type::eof();
+}
+
+std::streamsize SocketBuffer::xsputn(const char* text, const std::streamsize size) {
+    std::streamsize sent = 0;
+    while (sent < size) {                       // MSG_NOSIGNAL: a client that left is an error, not a SIGPIPE.
+        const ssize_t result = send(socket, text + sent, static_cast<size_t>(size - sent), MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) break;
+        sent += result;
+    }
+    return sent;
+}
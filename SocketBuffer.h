@@ -0,0 +1,32 @@
+#ifndef SOCKETBUFFER_H
+#define SOCKETBUFFER_H
+
+#include <streambuf>
+
+#define SOCKET_BUFFER_SIZE 4096     // Bytes received at once.
+
+/**
+ *  SocketBuffer class
+ *  This class is a std::streambuf over a connected socket, so a server client can be read with std::getline
+ *  and written through a ResultWriter exactly like std::cin and std::cout.
+ *  Input is received in chunks into a small buffer, output is sent as soon as it is written,
+ *  (the ResultWriter above it already buffers) a closed or broken connection ends the input.
+ *
+ *  The big 3:
+ *  Not implemented because the socket is not owned by the buffer, the session that accepted it closes it,
+ *  copying is deleted by std::streambuf.
+ ***/
+class SocketBuffer : public std::streambuf {
+    int socket;                             // Connected socket.
+    char input[SOCKET_BUFFER_SIZE];         // Received bytes not read yet.
+
+protected:
+    int_type underflow() override;                                  // Receives the next chunk.
+    int_type overflow(int_type c) override;                         // Sends a single character.
+    std::streamsize xsputn(const char* text, std::streamsize size) override;   // Sends size characters.
+
+public:
+    explicit SocketBuffer(int _socket);
+};
+
+#endif //SOCKETBUFFER_H
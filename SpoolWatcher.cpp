@@ -0,0 +1,120 @@
+#include "SpoolWatcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <dirent.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FileException.h"
+
+SpoolWatcher::SpoolWatcher(const std::string& _directory, Apply _apply)
+: directory(_directory), apply(std::move(_apply)) {
+    notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notify < 0 || inotify_add_watch(notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0 ||
+        pipe(wake) != 0) {
+        if (notify >= 0) close(notify);
+        throw FileNotFoundException(directory);
+    }
+    worker = std::thread(&SpoolWatcher::run, this);
+}
+
+SpoolWatcher::~SpoolWatcher() {
+    const char stop = 0;
+    while (write(wake[1], &stop, 1) < 0 && errno == EINTR) {}
+    worker.join();
+    close(wake[0]);
+    close(wake[1]);
+    close(notify);
+}
+
+// Skips hidden (still being written) files.
+static bool is_spooled(const char* name) {
+    return name[0] != '\0' && name[0] != '.';
+}
+
+// Version of a file from its status.
+static SpoolWatcher::Version version_of(const struct stat& status) {
+    return {static_cast<long long>(status.st_mtim.tv_sec), static_cast<long long>(status.st_mtim.tv_nsec),
+            static_cast<long long>(status.st_size)};
+}
+
+void SpoolWatcher::scan(std::vector<Arrival>& batch) {
+    DIR* spool = opendir(directory.c_str());
+    if (spool == nullptr) return;
+    std::vector<std::string> names;
+    for (const dirent* entry = readdir(spool); entry != nullptr; entry = readdir(spool)) {
+        struct stat status{};
+        const std::string path = directory + "/" + entry->d_name;
+        if (!is_spooled(entry->d_name) || stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode))
+            continue;
+        const auto found = arrived.find(path);
+        if (found != arrived.end() && found->second == version_of(status))
+            continue;                                   // Loaded as it is now.
+        arrived[path] = version_of(status);
+        names.push_back(path);
+    }
+    closedir(spool);
+    std::sort(names.begin(), names.end());
+    const auto now = Stats::now();
+    for (auto& name : names)
+        batch.push_back(Arrival{std::move(name), now});
+}
+
+void SpoolWatcher::read_events(std::vector<Arrival>& batch) {
+    alignas(inotify_event) char events[WATCH_EVENTS_SIZE];
+    ssize_t size;
+    bool overflow = false;
+    while ((size = read(notify, events, sizeof(events))) > 0) {
+        const auto now = Stats::now();
+        for (const char* event = events; event < events + size; ) {
+            const auto* notified = reinterpret_cast<const inotify_event*>(event);
+            overflow = overflow || (notified->mask & IN_Q_OVERFLOW);
+            if (notified->len > 0 && !(notified->mask & IN_ISDIR) && is_spooled(notified->name)) {
+                const std::string path = directory + "/" + notified->name;
+                struct stat status{};
+                if (stat(path.c_str(), &status) == 0) arrived[path] = version_of(status);
+                batch.push_back(Arrival{path, now});
+            }
+            event += sizeof(inotify_event) + notified->len;
+        }
+    }
+    if (overflow) scan(batch);                          // Files that arrived may have no event.
+}
+
+void SpoolWatcher::deliver(std::vector<Arrival>& batch) {
+    try {
+        apply(batch);
+    }catch (std::exception& e) {                        // Never ends the thread, the next batch may be fine.
+        std::cerr << e.what();
+    }
+    batch.clear();
+}
+
+void SpoolWatcher::run() {
+    std::vector<Arrival> batch;
+    scan(batch);
+    read_events(batch);                                 // Files closed while scanning, maybe scanned already.
+    if (!batch.empty()) deliver(batch);                 // The files already there do not wait for the window.
+    while (true) {
+        int timeout = -1;                               // Nothing pending, wait for the next file.
+        if (!batch.empty()) {
+            const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+                Stats::now() - batch.front().time).count();
+            timeout = batch.size() >= WATCH_BATCH_FILES ? 0 : std::max(0, WATCH_BATCH_MS - static_cast<int>(waited));
+        }
+        if (timeout != 0) {
+            pollfd watched[2] = {{notify, POLLIN, 0}, {wake[0], POLLIN, 0}};
+            const int ready = poll(watched, 2, timeout);
+            if (ready < 0 && errno != EINTR) return;
+            if (watched[1].revents != 0) return;        // Stopped.
+            if (watched[0].revents & POLLIN) {
+                read_events(batch);
+                continue;                               // Maybe more files of the same burst.
+            }
+            if (ready != 0) continue;
+        }
+        deliver(batch);
+    }
+}
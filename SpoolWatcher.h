@@ -0,0 +1,74 @@
+#ifndef SPOOLWATCHER_H
+#define SPOOLWATCHER_H
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Stats.h"
+
+#define WATCH_BATCH_MS 100              // A batch is applied at most this long after its first file arrived,
+#define WATCH_BATCH_FILES 1024          // Or as soon as it holds this many files.
+#define WATCH_EVENTS_SIZE 65536         // Bytes of inotify events read at once.
+
+/**
+ *  SpoolWatcher class
+ *  This class watches a spool directory (inotify) on its own thread, and hands the files that arrive to the
+ *  Terminal in batches, so a burst of files is a single update of the graphs instead of an update per file.
+ *  A file arrives when it is closed after writing, or moved into the directory, names starting with '.' are
+ *  skipped, so a carrier can write .name and rename it when it is complete.
+ *  The files already in the directory when the watch starts are the first batch, (sorted by name) with the files
+ *  closed while they were listed, a file in both is loaded once. A file that arrives again is reloaded by the Terminal,
+ *  (see Terminal::ingest) it replaces what was loaded from it before.
+ *  If the kernel dropped events (its queue overflowed) the directory is listed again, and every file that is new or
+ *  changed (modification time or size) since it last arrived is in the next batch, the others are not loaded again.
+ *  Every later batch is applied WATCH_BATCH_MS after its first file arrived, or once it holds WATCH_BATCH_FILES,
+ *  So the latency from arrival to queryable data is the window, plus parsing and inserting the batch, plus a copy
+ *  and a compile of the whole graphs once per batch. (see Terminal::update) The last part grows with the size of the
+ *  graphs, not of the batch, it is paid once for up to WATCH_BATCH_FILES files.
+ *
+ *  The big 3:
+ *  The destructor is implemented, it stops the thread and closes the inotify instance and the wake pipe.
+ *  Copying is deleted, the thread and the file descriptors have a single owner.
+ ***/
+class SpoolWatcher {
+public:
+    // A file that arrived, and when it was seen.
+    struct Arrival {
+        std::string file_name;              // Path of the file, inside the directory.
+        Stats::Clock::time_point time;      // When the watcher saw it.
+    };
+    using Apply = std::function<void(const std::vector<Arrival>&)>;
+
+    // Modification time and size of a file when it arrived.
+    struct Version {
+        long long seconds, nanoseconds, size;
+        bool operator==(const Version& other) const {
+            return seconds == other.seconds && nanoseconds == other.nanoseconds && size == other.size;
+        }
+    };
+
+private:
+    std::string directory;          // Watched directory.
+    Apply apply;                    // Called with every batch, on the watcher thread.
+    int notify = -1;                // The inotify instance.
+    int wake[2] = {-1, -1};         // Pipe, written by the destructor to stop the thread.
+    std::thread worker;             // The watcher thread.
+    std::unordered_map<std::string, Version> arrived;       // Path -> its version when it last arrived.
+
+    void run();                                             // Collects and applies batches until stopped.
+    void deliver(std::vector<Arrival>& batch);              // Applies batch and clears it.
+    void scan(std::vector<Arrival>& batch);                 // Adds the new or changed files of the directory.
+    void read_events(std::vector<Arrival>& batch);          // Adds the files of the pending inotify events.
+
+public:
+    // Starts watching directory, throws FileNotFoundException if it cannot be watched.
+    SpoolWatcher(const std::string& _directory, Apply _apply);
+    ~SpoolWatcher();
+
+    SpoolWatcher(const SpoolWatcher&) = delete;
+    SpoolWatcher& operator=(const SpoolWatcher&) = delete;
+};
+
+#endif //SPOOLWATCHER_H
@@ -0,0 +1,137 @@
+#include "Stats.h"
+#include <algorithm>
+
+// Values below 2 * SUB_BUCKETS get a bucket each, larger values are split by their highest bit,
+// And by the SUB_BUCKETS values of the 3 bits below it.
+size_t Stats::Histogram::bucket(const uint64_t nanoseconds) {
+    if (nanoseconds < 2 * SUB_BUCKETS) return static_cast<size_t>(nanoseconds);
+    int high = 63;
+    while (!(nanoseconds >> high)) --high;
+    const size_t sub = static_cast<size_t>(nanoseconds >> (high - 3)) & (SUB_BUCKETS - 1);
+    return 2 * SUB_BUCKETS + static_cast<size_t>(high - 4) * SUB_BUCKETS + sub;
+}
+
+uint64_t Stats::Histogram::upper_bound(const size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) return bucket;
+    const int high = static_cast<int>((bucket - 2 * SUB_BUCKETS) / SUB_BUCKETS) + 4;
+    const uint64_t sub = (bucket - 2 * SUB_BUCKETS) % SUB_BUCKETS;
+    const uint64_t lowest = (uint64_t{1} << high) + (sub << (high - 3));
+    return lowest + (uint64_t{1} << (high - 3)) - 1;
+}
+
+void Stats::Histogram::add(const uint64_t nanoseconds) {
+    ++buckets[bucket(nanoseconds)];
+    ++count;
+    if (nanoseconds > max) max = nanoseconds;
+}
+
+void Stats::Histogram::merge(const Histogram& other) {
+    for (size_t b = 0; b < buckets.size(); ++b)
+        buckets[b] += other.buckets[b];
+    count += other.count;
+    if (other.max > max) max = other.max;
+}
+
+uint64_t Stats::Histogram::percentile(const double p) const {
+    if (count == 0) return 0;
+    const uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count - 1)) + 1;     // 1 based.
+    uint64_t seen = 0;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        seen += buckets[b];
+        if (seen >= rank) return upper_bound(b) < max ? upper_bound(b) : max;
+    }
+    return max;
+}
+
+// Nanoseconds since start, 0 if the clock went back.
+static uint64_t elapsed_since(const Stats::Clock::time_point start) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Stats::Clock::now() - start).count();
+    return static_cast<uint64_t>(elapsed < 0 ? 0 : elapsed);
+}
+
+// The histogram of operation in histograms, created the first time.
+static Stats::Histogram& slot(Stats::Histograms& histograms, const Stats::Operation operation) {
+    if (histograms.size() <= operation) histograms.resize(operation + 1);
+    if (!histograms[operation]) histograms[operation].reset(new Stats::Histogram());
+    return *histograms[operation];
+}
+
+// Adds every histogram of from into to.
+static void merge(Stats::Histograms& to, const Stats::Histograms& from) {
+    for (Stats::Operation operation = 0; operation < from.size(); ++operation)
+        if (from[operation]) slot(to, operation).merge(*from[operation]);
+}
+
+Stats::Recorder::Recorder(Stats& _stats) : stats(_stats) {
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    stats.recorders.push_back(this);
+}
+
+Stats::Recorder::~Recorder() {
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    merge(stats.operations, histograms);            // No other thread records into it anymore.
+    stats.recorders.erase(std::find(stats.recorders.begin(), stats.recorders.end(), this));
+}
+
+void Stats::Recorder::record(const std::string& operation, const Clock::time_point start) {
+    const uint64_t elapsed = elapsed_since(start);
+    auto found = ids.find(operation);
+    if (found == ids.end())                         // Interned once per name, under the mutex of stats.
+        found = ids.emplace(operation, stats.intern(operation)).first;
+    std::lock_guard<std::mutex> lock(mutex);
+    slot(histograms, found->second).add(elapsed);
+}
+
+Stats::Operation Stats::intern(const std::string& operation) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto found = ids.emplace(operation, names.size());
+    if (found.second) names.push_back(operation);
+    return found.first->second;
+}
+
+void Stats::record(const std::string& operation, const Clock::time_point start) {
+    const uint64_t elapsed = elapsed_since(start);
+    const Operation id = intern(operation);
+    std::lock_guard<std::mutex> lock(mutex);
+    slot(operations, id).add(elapsed);
+}
+
+void Stats::ingested(const size_t file_lines) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++files;
+    lines += file_lines;
+}
+
+void Stats::failed(const Failure failure) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++failures[static_cast<size_t>(failure)];
+}
+
+std::map<std::string, Stats::Histogram> Stats::get_operations() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Histograms all;
+    merge(all, operations);
+    for (const Recorder* recorder : recorders) {
+        std::lock_guard<std::mutex> recorder_lock(recorder->mutex);
+        merge(all, recorder->histograms);
+    }
+    std::map<std::string, Histogram> merged;
+    for (Operation operation = 0; operation < all.size(); ++operation)
+        if (all[operation]) merged.emplace(names[operation], *all[operation]);
+    return merged;
+}
+
+uint64_t Stats::get_files() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return files;
+}
+
+uint64_t Stats::get_lines() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lines;
+}
+
+uint64_t Stats::get_failures(const Failure failure) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failures[static_cast<size_t>(failure)];
+}
@@ -0,0 +1,108 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define SUB_BUCKETS 8                               // Linear buckets per power of 2, (at most 12.5% error)
+#define HISTOGRAM_BUCKETS (2 * SUB_BUCKETS + 60 * SUB_BUCKETS)
+
+/**
+ *  Stats class
+ *  This class collects the instrumentation of the terminal:
+ *   - the count and latency histogram of every command and internal operation (parse, add_file),
+ *   - files and lines ingested, and the files that failed by type of failure.
+ *  A latency is added into a fixed size log-linear histogram, (power of 2 buckets, each split into 8)
+ *  So recording is a clock read, a few shifts and an increment, cheap enough to leave on all the time,
+ *  And p50 / p99 are read from the buckets, with the exact maximum kept next to them.
+ *  Operation names are interned into ids once, every command is recorded by the Recorder of its thread, (the terminal,
+ *  or a server session) into its own histograms by operation id, so server sessions never wait for each other,
+ *  Their histograms are merged when get_operations runs (the stats command) or when the recorder ends.
+ *  The other methods take the mutex of the Stats, they are called by updates (one at a time) and by the stats command.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers, value types and a mutex,
+ *  the compiler-generated destructor is enough, copying is deleted by the mutex.
+ *  Every Recorder must end before its Stats.
+ ***/
+class Stats {
+public:
+    using Clock = std::chrono::steady_clock;
+    enum class Failure { NOT_OPENED, INVALID_LINE, ERROR };
+
+    // Latencies of a single operation, in nanoseconds.
+    class Histogram {
+        std::array<uint64_t, HISTOGRAM_BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t max = 0;
+
+        static size_t bucket(uint64_t nanoseconds);         // Bucket of a latency.
+        static uint64_t upper_bound(size_t bucket);         // Largest latency of a bucket.
+
+    public:
+        void add(uint64_t nanoseconds);
+        void merge(const Histogram& other);                 // Adds the latencies of other.
+        uint64_t percentile(double p) const;                // Upper bound of the bucket holding the percentile.
+        uint64_t get_count() const { return count; }        // Count getter.
+        uint64_t get_max() const { return max; }            // Max getter.
+    };
+
+    using Operation = size_t;                       // Interned id of an operation name.
+    using Histograms = std::vector<std::unique_ptr<Histogram>>;     // Operation id -> latencies, null if none yet.
+
+    // Records the commands of a single thread into histograms of its own, its mutex is only contended while
+    // get_operations reads them. Registered into stats until it is destroyed, then its histograms are merged into it.
+    class Recorder {
+        Stats& stats;
+        mutable std::mutex mutex;                               // Guards histograms.
+        Histograms histograms;                                  // Its latencies.
+        std::unordered_map<std::string, Operation> ids;         // Names interned so far, read without any lock.
+
+        friend class Stats;
+
+    public:
+        explicit Recorder(Stats& _stats);
+        ~Recorder();
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        // Adds the time since start to operation.
+        void record(const std::string& operation, Clock::time_point start);
+    };
+
+private:
+    mutable std::mutex mutex;                       // Guards all the fields below.
+    std::vector<std::string> names;                 // Operation id -> name.
+    std::unordered_map<std::string, Operation> ids; // Operation name -> id.
+    Histograms operations;                          // Latencies of record and of the recorders that ended.
+    std::vector<Recorder*> recorders;               // Recorders alive.
+    uint64_t files = 0;                             // Files ingested.
+    uint64_t lines = 0;                             // Lines of the files ingested.
+    std::array<uint64_t, 3> failures{};             // Files that failed, by Failure.
+
+public:
+    static Clock::time_point now() { return Clock::now(); }
+
+    // Returns the id of operation, a new one the first time.
+    Operation intern(const std::string& operation);
+
+    // Adds the time since start to operation, under the mutex. (internal operations of updates, see Recorder)
+    void record(const std::string& operation, Clock::time_point start);
+
+    void ingested(size_t file_lines);               // A file was inserted into the graphs.
+    void failed(Failure failure);                   // A file could not be inserted.
+
+    std::map<std::string, Histogram> get_operations() const;   // All operations recorded, merged, sorted by name.
+    uint64_t get_files() const;                                 // Files getter.
+    uint64_t get_lines() const;                                 // Lines getter.
+    uint64_t get_failures(Failure failure) const;               // Failures getter.
+};
+
+#endif //STATS_H
@@ -1,188 +1,588 @@
 #include "Terminal.h"
 #include "FileException.h"
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <set>
+#include <unordered_set>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include "SailDetails.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
+#include "SocketBuffer.h"
+#include "Voyage.h"
 #include "CommandGenerator.cpp"
 
-#define FILLER_STRING "0"
-#define ARRIVAL_BEFORE_DEPARTURE (-1) // bad date inside a file. arrival of a boat before the previous boat arrived.
-
 Terminal::Terminal() {
     // graphs = std::make_unique<Graph<std::string>>(); <-- csweb compiler didn't like this line, so line 14 was born
-    graphs = std::unique_ptr<Graph<std::string>>(new Graph<std::string>());
+    graphs = std::shared_ptr<Graph<std::string>>(new Graph<std::string>());
+    writer = std::unique_ptr<ResultWriter>(new ResultWriter(std::cout));
+    stats = std::unique_ptr<Stats>(new Stats());
     output_file = DEFAULT_OUTPUT_FILE;
 }
 
+// Executes a single command line, results and errors go to writer.
+// The latency of every command is recorded by the recorder of the thread, (lines that are not a command as "invalid")
+// Returns false if the line is the exit command.
+static bool execute_command(const std::string& inputString, const std::map<std::string, CommandFunction>& commands,
+                            ResultWriter& writer, Stats::Recorder& stats) {
+    std::stringstream stream(inputString);
+    std::string token1, token2, token3, extra;
+
+    if (inputString.find(',') != std::string::npos) {   // Read the line, separate by ',' should be 2 or 3 words.
+        std::getline(stream, token1, ',');
+        std::getline(stream, token2, ',');
+        std::getline(stream, token3);
+    } else {
+        stream >> token1;
+        if (token1 == "load")                            // load <file> [<file> ...], all files are token2.
+            std::getline(stream >> std::ws, token2);
+        else
+            stream >> token2 >> token3 >> extra;         // Command without ',' should be 1 word.
+    }
+    if (extra.empty() && token1 == "exit") return false;
+
+    const auto start = Stats::now();
+    writer.begin(inputString);
+    if (!extra.empty()) {   // Extra command! -> bad input.
+        printError(writer);
+        writer.end();
+        stats.record("invalid", start);
+        return true;
+    }
+
+    auto command_at_token1 = commands.find(token1);
+    auto command_at_token2 = commands.find(token2);
+    const std::string* name = nullptr;
+    try {                                                  // Find command and execute, else exception is thrown,
+        if (command_at_token1 != commands.end()) {         // Or bad input.
+            name = &command_at_token1->first;
+            command_at_token1->second(token2,token3);
+        }
+        else if (command_at_token2 != commands.end()) {
+            name = &command_at_token2->first;
+            command_at_token2->second(token1,token3);
+        }else {
+            printError(writer);
+        }
+    }catch (std::exception& e) {
+        writer.error(e.what());
+    }
+    writer.end();
+    stats.record(name ? *name : "invalid", start);
+    return true;
+}
+
 // Starts the mini terminal after the initialization.
 // Command maps are ['command': lambda function], for more information, go to CommandGenerator.cpp
 void Terminal::start_terminal() {
     std::string inputString;
-    auto commands = buildCommandsMap(*this, *this->graphs);
+    auto commands = buildCommandsMap(*this, *this->writer, cache);
+    Stats::Recorder recorder(*stats);
 
-    while (true) {
-        std::getline(std::cin, inputString);
+    while (std::getline(std::cin, inputString)) {           // Until exit, or the end of the input.
+        if (!execute_command(inputString, commands, *writer, recorder)) break;
+    }
+    writer->flush();
+}
 
-        std::stringstream stream(inputString);
-        std::string token1, token2, token3, extra;
+// Batch mode, runs every command of a script file against the loaded graphs, same commands and errors
+// as the mini terminal, until exit or the end of the script. Results are buffered by the writer.
+void Terminal::run_batch(const std::string& script_file) {
+    std::ifstream script(script_file);
+    if (!script.is_open()) {
+        throw FileNotFoundException(script_file);
+    }
+    std::string inputString;
+    auto commands = buildCommandsMap(*this, *this->writer, cache);
+    Stats::Recorder recorder(*stats);
 
-        if (inputString.find(',') != std::string::npos) {   // Read the line, separate by ',' should be 2 or 3 words.
-            std::getline(stream, token1, ',');
-            std::getline(stream, token2, ',');
-            std::getline(stream, token3);
-        } else {
-            stream >> token1 >> token2 >> token3 >> extra;   // Command without ',' should be 1 word.
-        }
-        if (!extra.empty()) {   // Extra command! -> bad input.
-            printError();
-            continue;
-        }
-        if (token1 == "exit") break;
+    while (std::getline(script, inputString)) {
+        if (!execute_command(inputString, commands, *writer, recorder)) break;
+    }
+    writer->flush();
+}
 
-        auto command_at_token1 = commands.find(token1);
-        auto command_at_token2 = commands.find(token2);
-        try {                                                  // Find command and execute, else exception is thrown,
-            if (command_at_token1 != commands.end()) {         // Or bad input.
-                command_at_token1->second(token2,token3);
-            }
-            else if (command_at_token2 != commands.end()) {
-                command_at_token2->second(token1,token3);
-            }else {
-                printError();
-            }
-        }catch (std::exception& e) {
-            std::cerr << e.what();
+// Set by SIGINT / SIGTERM, stops the server.
+static volatile std::sig_atomic_t stopping = 0;
+static int listener = -1;                       // Listening socket of the server.
+
+static void stop_server(int) {
+    stopping = 1;
+    if (listener >= 0) shutdown(listener, SHUT_RDWR);      // Wakes up accept.
+}
+
+// The connected clients of the server, a client is closed by its own session, or woken up when the server stops.
+struct ServerClients {
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::set<int> open;
+};
+
+// Server mode, accepts clients of a unix domain socket until SIGINT / SIGTERM, every client runs in its own session.
+// Before the first client the graphs are compiled and from now on every update is copy-on-write. (see update)
+void Terminal::serve(const std::string& socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+        throw FileNotFoundException(socket_path);
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    unlink(socket_path.c_str());                                // A socket left by a previous server.
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0) {
+        if (listener >= 0) close(listener);
+        listener = -1;
+        throw FileNotFoundException(socket_path);
+    }
+    graphs->prepare();                                          // The first published version.
+    concurrent = true;
+
+    struct sigaction action{};
+    action.sa_handler = stop_server;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    ServerClients clients;
+    while (!stopping) {
+        const int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            break;
         }
+        std::lock_guard<std::mutex> lock(clients.mutex);
+        clients.open.insert(client);
+        std::thread([this, client, &clients]() {
+            session(client);
+            std::lock_guard<std::mutex> finished(clients.mutex);
+            clients.open.erase(client);
+            close(client);
+            clients.finished.notify_all();
+        }).detach();
+    }
+
+    std::unique_lock<std::mutex> lock(clients.mutex);
+    for (const int client : clients.open)
+        shutdown(client, SHUT_RDWR);                            // Ends the sessions waiting for a command.
+    clients.finished.wait(lock, [&clients]() { return clients.open.empty(); });
+    close(listener);
+    listener = -1;
+    unlink(socket_path.c_str());
+}
+
+// Runs the commands of a server client until exit or until it disconnects, same commands as the mini terminal.
+// Every client has its own results writer and query cache, its errors are written back to it with its results.
+void Terminal::session(const int client) {
+    SocketBuffer buffer(client);
+    std::iostream stream(&buffer);
+    ResultWriter results(stream, format, 0, nullptr);
+    QueryCache session_cache(cache.get_capacity());
+    auto commands = buildCommandsMap(*this, results, session_cache);
+    Stats::Recorder recorder(*stats);                   // Its own latencies, sessions do not share a lock.
+
+    std::string inputString;
+    while (std::getline(stream, inputString)) {
+        if (!inputString.empty() && inputString.back() == '\r') inputString.pop_back();   // telnet like clients.
+        if (!execute_command(inputString, commands, results, recorder)) break;
     }
+    results.flush();
 }
 
 // Load 1 file command, receives a file name, reads its contents, upon any error a custom exception
-// is thrown, uses read_lines function.
-void Terminal::load(const char* file_name) const{
-    std::ifstream file(file_name);
+// is thrown, uses read_lines function. The file is parsed before the update starts.
+void Terminal::load(const char* file_name, ResultWriter& results) {
+    const MappedFile file(file_name);
     if (!file.is_open()) {
+        stats->failed(Stats::Failure::NOT_OPENED);
         throw FileNotFoundException(file_name);
     }
-    const int line_number = read_lines(file);
-    if (line_number != 0)
+    Voyage voyage;
+    const int line_number = read_lines(file, voyage);
+    if (line_number != 0) {
+        stats->failed(Stats::Failure::INVALID_LINE);
         throw InvalidInputException(file_name , line_number);
-    std::cout << "Update was successful." << std::endl;;
+    }
+    update([&](Graph<std::string>& graph) { add_voyage(graph, voyage, file_name); });
+    results.message("Update was successful.");
 }
 
-// Write into the output file command, prints both graphs inside the file.
-void Terminal::write_output_file(){
-    if(output_file.empty())
-        output_file = "output.dat";
-    std::ofstream outputFile(output_file);
-    this->graphs->print(outputFile,true);
-    this->graphs->print(outputFile,false);
+// Load many files command, receives file names, parses all of them in parallel (IngestPool), then inserts
+// them into the graphs in the given order, every file that fails prints its error and is skipped.
+// All files are a single update. If replace, every file replaces the voyages already loaded under its name. (see insert)
+void Terminal::load_files(const std::vector<std::string>& file_names, ResultWriter& results, const bool replace) {
+    const auto start = Stats::now();
+    const auto parsed = IngestPool().parse(file_names);
+    stats->record("parse_batch", start);
+    update([&](Graph<std::string>& graph) {
+        for (const auto& file : parsed) {
+            try {
+                insert(graph, file, results, replace);
+            }catch (std::exception& e) {
+                results.error(e.what());
+            }
+        }
+    });
 }
 
-// Initialization stage, find the outputfile if provided, and load all other files provided via read_lines
-// Function, upon any error here, exit the program with 1.
-void Terminal::read_files(const int argc, char* argv[]){
-    std::vector<std::string> argFiles;
-    try {
-        // Basic validation: must have at least "-i" and one input file
-        if (argc < 3 || std::strcmp(argv[1], "-i") != 0) {
-            throw InvalidFileArgumentsException();
-        }
-        int k = 2;
+// Unload command, removes every voyage loaded from file_name (the name it was loaded with) from the graphs,
+// In O(legs of the file * log) amortized time. (see Graph::unload) Throws FileNotLoadedException if it was not loaded.
+void Terminal::unload(const std::string& file_name, ResultWriter& results) {
+    update([&](Graph<std::string>& graph) {
+        if (graph.unload(file_name) == 0)
+            throw FileNotLoadedException(file_name);
+    });
+    results.message("Update was successful.");
+}
 
-        // Collect input files until "-o" or end of args
-        for (; k < argc; ++k) {
-            if (std::strcmp(argv[k], "-o") == 0)
-                break;
-            argFiles.emplace_back(argv[k]);
-        }
+// Inserts a parsed file into the graphs, same checks and messages as load, upon any error a custom
+// exception is thrown. If replace, the voyages already loaded under its name are unloaded first, only once the file
+// passed the checks, so a bad file leaves them loaded.
+void Terminal::insert(Graph<std::string>& graph, const IngestPool::ParsedFile& parsed, ResultWriter& results,
+                      const bool replace) const {
+    if (parsed.line_number == FILE_NOT_OPENED) {
+        stats->failed(Stats::Failure::NOT_OPENED);
+        throw FileNotFoundException(parsed.file_name);
+    }
+    if (parsed.error) {
+        stats->failed(Stats::Failure::ERROR);
+        std::rethrow_exception(parsed.error);
+    }
+    if (parsed.line_number != 0) {
+        stats->failed(Stats::Failure::INVALID_LINE);
+        throw InvalidInputException(parsed.file_name , parsed.line_number);
+    }
+    if (replace) graph.unload(parsed.file_name);
+    add_voyage(graph, parsed.voyage, parsed.file_name);
+    results.message("Update was successful.");
+}
 
-        if (argFiles.empty()) {
-            throw InvalidFileArgumentsException();  // Must contain at least 1 input file
-        }
+// Inserts a parsed voyage into graph, the time of add_file, the file and its lines are counted in stats.
+void Terminal::add_voyage(Graph<std::string>& graph, const Voyage& voyage, const std::string& file_name) const {
+    const auto start = Stats::now();
+    graph.add_file(voyage.get_source(), voyage.get_details(), voyage.get_destinations(), file_name);
+    stats->record("add_file", start);
+    stats->ingested(voyage.get_details().size());       // A line per SailDetails, the source included.
+}
 
-        // If -o is present and followed by a valid filename, set output_file
-        if (k < argc && std::strcmp(argv[k], "-o") == 0)
-            if (k + 1 < argc && argv[k + 1][0] != '-') {
-                output_file = argv[k + 1];
-            }
+// Watch mode, loads a batch of files that arrived in the watched directory as a single update, (see load_files)
+// A file that arrived twice in the batch is loaded once. A file that arrives again in a later batch (written again,
+// or copied over) is reloaded: its new voyages replace the ones loaded from it before, so a file is never counted
+// twice, if its new contents are bad the old voyages stay. Bad files are reported like any load, into std::cerr,
+// Successful files are not reported, the terminal may be in the middle of another command.
+// The time from the arrival of every file until it can be queried is recorded as watch_latency.
+void Terminal::ingest(const std::vector<SpoolWatcher::Arrival>& arrivals) {
+    std::vector<std::string> file_names;
+    std::unordered_set<std::string> seen;
+    for (const auto& arrival : arrivals)
+        if (seen.insert(arrival.file_name).second) file_names.push_back(arrival.file_name);
 
-        std::ifstream firstFile(argFiles[0]);
-        if (!firstFile.is_open()) {
-            throw InvalidInputExceptionExit(argFiles[0]);   // Could not open file
-        }
-        const int line_number = read_lines(firstFile);
-        if (line_number != 0)
-            throw InvalidInputExceptionExit(argFiles[0] , line_number); // The First file must be valid
-    }catch (std::exception& e) {
-        std::cerr << e.what();
-        exit(1);
+    std::ostream discard(nullptr);                      // No stream buffer, every write is dropped.
+    ResultWriter results(discard);
+    load_files(file_names, results, true);
+    for (const auto& arrival : arrivals)
+        stats->record("watch_latency", arrival.time);
+}
+
+// Returns the latest version of the graphs, it does not change while the caller holds it in server mode.
+std::shared_ptr<const Graph<std::string>> Terminal::snapshot() const {
+    return std::atomic_load(&graphs);
+}
+
+// Applies a change to the graphs, one update at a time.
+// In server and watch mode the change is applied to a copy of the latest version, the copy is compiled (prepare)
+// And then published, queries that already hold the previous version keep reading it.
+// A copy and a compile cost as much as the graphs, so updates are group committed: the first update to arrive while
+// no batch is running leads the next one, it takes every update waiting so far (its own included) and applies all of
+// them to a single copy, the others wait for it and get their own exception back, if any.
+// apply must leave the graphs unchanged if it throws, (every update checks its input first) the other updates of its
+// batch are still published. If every update of a batch throws, nothing is published.
+void Terminal::update(const std::function<void(Graph<std::string>&)>& apply) {
+    if (!concurrent) {
+        std::lock_guard<std::mutex> lock(update_mutex);
+        apply(*graphs);
+        return;
+    }
+    PendingUpdate mine{&apply, nullptr, false};
+    std::unique_lock<std::mutex> lock(pending_mutex);
+    pending.push_back(&mine);
+    applied.wait(lock, [&]() { return mine.done || !updating; });
+    if (!mine.done) {                                       // Leads the next batch.
+        std::vector<PendingUpdate*> batch;
+        batch.swap(pending);
+        updating = true;
+        lock.unlock();
+        apply_batch(batch);
+        lock.lock();
+        for (auto* waiting : batch)
+            waiting->done = true;
+        updating = false;
+        applied.notify_all();
     }
+    if (mine.error) std::rethrow_exception(mine.error);
+}
 
-    if (!argFiles.empty()) {                        // Load all other files, can fail
-        argFiles.erase(argFiles.begin());
-        for (auto& string : argFiles) {
+// Applies every update of batch, in order, to a single copy of the latest version, then compiles and publishes it.
+void Terminal::apply_batch(const std::vector<PendingUpdate*>& batch) {
+    std::lock_guard<std::mutex> lock(update_mutex);
+    try {
+        std::shared_ptr<Graph<std::string>> next(new Graph<std::string>(*graphs));
+        bool changed = false;
+        for (auto* waiting : batch) {
             try {
-                load(string.c_str());
-            }catch (std::exception& e) {
-                std::cerr << e.what();
+                (*waiting->apply)(*next);
+                changed = true;
+            }catch (...) {
+                waiting->error = std::current_exception();
             }
         }
+        if (!changed) return;
+        next->prepare();
+        std::atomic_store(&graphs, next);
+    }catch (...) {                                          // Out of memory, nothing was published.
+        for (auto* waiting : batch)
+            if (!waiting->error) waiting->error = std::current_exception();
     }
-    start_terminal();
 }
 
-// Read_lines helper function, receives a file, and reads its contents via
-// The provided guidelines, check the dates provided, and the non-negative container count,
-// And the amounts of data in a single line, upon any error, return the line number that the error occurred in.
-// Uses helper functions from Utils.h.
-int Terminal::read_lines(std::ifstream& file) const {
-    std::string line ,source_port;
-    bool first_rotation = true;
-    int line_number = 1;
+// Write into the output file command, prints both graphs into file_name, or into the outputfile if it is empty,
+// (the outputfile keeps its name) upon any error a custom exception is thrown.
+void Terminal::write_output_file(const std::string& file_name){
+    const auto graph = snapshot();
+    std::lock_guard<std::mutex> lock(update_mutex);            // A single writer of the output file.
+    if(output_file.empty())
+        output_file = DEFAULT_OUTPUT_FILE;
+    const std::string& target = file_name.empty() ? output_file : file_name;
+    if (!graph->print(target, OutputWriter())) {
+        throw FileNotFoundException(target);
+    }
+}
 
-    std::vector<SailDetails> details;
-    std::vector<std::string> dest_ports;
+// Balances command, writes the balance of every port at date as results, or into file_name if one is provided,
+// upon any error a custom exception is thrown.
+void Terminal::write_balances(const std::string& date, const std::string& file_name, ResultWriter& results) const {
+    const auto graph = snapshot();
+    if (file_name.empty()) {
+        graph->balances(date, results);
+        return;
+    }
+    std::ofstream file(file_name);
+    if (!file.is_open()) {
+        throw FileNotFoundException(file_name);
+    }
+    ResultWriter file_writer(file, ResultWriter::Format::TEXT, BATCH_BUFFER_SIZE);
+    graph->balances(date, file_writer);
+    file_writer.flush();
+    results.message("Balances were written to " + file_name + ".");
+}
 
-    while(std::getline(file, line)) {
-        auto tokens = split_line(line);
+// Stats command, writes the count and latencies (microseconds) of every command and operation, the ingest counters,
+// the size of the graphs and the cache counters, as name,value results.
+void Terminal::write_stats(ResultWriter& results, const QueryCache& query_cache) const {
+    const auto graph = snapshot();
+    for (const auto& operation : stats->get_operations()) {
+        const Stats::Histogram& histogram = operation.second;
+        const std::string& name = operation.first;
+        results.row(name + ".count", static_cast<long long>(histogram.get_count()));
+        results.row(name + ".p50_us", static_cast<long long>(histogram.percentile(0.50) / 1000));
+        results.row(name + ".p99_us", static_cast<long long>(histogram.percentile(0.99) / 1000));
+        results.row(name + ".max_us", static_cast<long long>(histogram.get_max() / 1000));
+    }
+    results.row("ingest.files", static_cast<long long>(stats->get_files()));
+    results.row("ingest.lines", static_cast<long long>(stats->get_lines()));
+    results.row("ingest.failures.not_opened", static_cast<long long>(stats->get_failures(Stats::Failure::NOT_OPENED)));
+    results.row("ingest.failures.invalid_line", static_cast<long long>(stats->get_failures(Stats::Failure::INVALID_LINE)));
+    results.row("ingest.failures.error", static_cast<long long>(stats->get_failures(Stats::Failure::ERROR)));
+    results.row("graph.ports", static_cast<long long>(graph->port_count()));
+    results.row("graph.container_edges", static_cast<long long>(graph->container_edge_count()));
+    results.row("graph.timing_edges", static_cast<long long>(graph->timing_edge_count()));
+    results.row("graph.voyages", static_cast<long long>(graph->voyage_count()));
+    results.row("cache.hits", static_cast<long long>(query_cache.get_hits()));
+    results.row("cache.misses", static_cast<long long>(query_cache.get_misses()));
+}
 
-        if (first_rotation) {                       // source port at the first line of each file. (2 words)
-            if (tokens.size() != 2) return line_number;
+// Save command, writes the whole network into a binary snapshot file, upon any error a custom exception is thrown.
+void Terminal::save(const std::string& file_name, ResultWriter& results) const {
+    Snapshot::save(*snapshot(), file_name);
+    results.message("Snapshot was saved.");
+}
 
-            source_port = tokens[0];
-            const std::string& departure_time = tokens[1];
+// Restore command, replaces the whole network with a binary snapshot file, upon any error a custom exception
+// is thrown and the network is not changed.
+void Terminal::restore(const std::string& file_name, ResultWriter& results) {
+    update([&](Graph<std::string>& graph) { Snapshot::restore(graph, file_name); });
+    results.message("Snapshot was restored.");
+}
 
-            if (!check_input(source_port, departure_time, FILLER_STRING, departure_time)) {
-                return line_number;
-            }
+// Archive command, writes every loaded voyage into a compressed archive file, upon any error a custom exception
+// is thrown.
+void Terminal::archive(const std::string& file_name, ResultWriter& results) const {
+    VoyageArchive archive;
+    snapshot()->archive(archive);
+    archive.save(file_name);
+    results.message("Archive was saved.");
+}
 
-            details.emplace_back(0,0,departure_time,source_port);
-            first_rotation = false;
+// Load archive command, adds every voyage of an archive file into the graphs, recorded under the archive file name
+// So it can be unloaded again, upon any error a custom exception is thrown and the graphs are not changed.
+void Terminal::load_archive(const std::string& file_name, ResultWriter& results) {
+    VoyageArchive archive;
+    archive.open(file_name);
+    update([&](Graph<std::string>& graph) { graph.add_archive(archive, file_name); });
+    results.message("Archive was loaded.");
+}
+
+// History command, opens an archive file as the history of the graphs, its voyages stay compressed in memory and
+// are added to the balance queries, upon any error a custom exception is thrown and the history is not changed.
+// An archive that holds a loaded voyage is refused, (see Graph::set_history) its containers would be counted twice.
+void Terminal::history(const std::string& file_name, ResultWriter& results) {
+    std::shared_ptr<VoyageArchive> archive(new VoyageArchive());
+    archive->open(file_name);
+    update([&](Graph<std::string>& graph) { graph.set_history(archive, file_name); });
+    results.message("History was opened.");
+}
+
+// True for the options that may follow the input files.
+static bool is_option(const char* arg) {
+    return std::strcmp(arg, "-o") == 0 || std::strcmp(arg, BATCH_FLAG) == 0 || std::strcmp(arg, JSON_FLAG) == 0 ||
+           std::strcmp(arg, CACHE_FLAG) == 0 || std::strcmp(arg, SERVE_FLAG) == 0 || std::strcmp(arg, WATCH_FLAG) == 0;
+}
+
+// Initialization stage, restore the snapshot if provided, find the outputfile if provided, and load all other
+// files provided via read_lines Function, upon any error here, exit the program with 1.
+void Terminal::read_files(const int argc, char* argv[]){
+    std::vector<std::string> argFiles;
+    std::vector<IngestPool::ParsedFile> parsed;
+    std::string snapshot_file, batch_file, socket_path, watch_directory;
+    bool json = false;
+    try {
+        int k = 1;
+        if (k < argc && std::strcmp(argv[k], SNAPSHOT_FLAG) == 0) {     // Optional snapshot, restored first
+            if (k + 1 >= argc)
+                throw InvalidFileArgumentsException();
+            snapshot_file = argv[k + 1];
+            k += 2;
         }
-        else {                                      // All lines after the source port. (4 words)
-            if (tokens.size() != 4) return line_number;
 
-            const std::string& dest_port          = tokens[0];
-            const std::string& arrival_time       = tokens[1];
-            const std::string& container_quantity = tokens[2];
-            const std::string& departure_time     = tokens[3];
+        // Basic validation: must have at least "-i" and one input file, unless a snapshot or a watch was provided
+        if (k < argc && std::strcmp(argv[k], "-i") == 0) {
+            // Collect input files until an option ("-o", "-b", "--json", "--cache", "--serve", "--watch") or end of args
+            for (++k; k < argc && !is_option(argv[k]); ++k) {
+                argFiles.emplace_back(argv[k]);
+            }
+            if (argFiles.empty()) {
+                throw InvalidFileArgumentsException();  // Must contain at least 1 input file
+            }
+        }
 
-            if (!check_input(dest_port, arrival_time, container_quantity, departure_time)) {
-                return line_number;
+        for (; k < argc; ++k) {
+            // If -o is present and followed by a valid filename, set output_file
+            if (std::strcmp(argv[k], "-o") == 0) {
+                if (k + 1 < argc && argv[k + 1][0] != '-') {
+                    output_file = argv[++k];
+                }
+            } else if (std::strcmp(argv[k], BATCH_FLAG) == 0) {    // -b <script>, run the script instead of the terminal
+                if (k + 1 >= argc)
+                    throw InvalidFileArgumentsException();
+                batch_file = argv[++k];
+            } else if (std::strcmp(argv[k], JSON_FLAG) == 0) {     // --json, results as JSON lines
+                json = true;
+            } else if (std::strcmp(argv[k], CACHE_FLAG) == 0) {    // --cache <entries>, 0 disables the cache
+                int capacity = 0;
+                if (k + 1 >= argc || !scan_number(argv[k + 1], std::strlen(argv[k + 1]), capacity) || capacity < 0)
+                    throw InvalidFileArgumentsException();
+                cache.set_capacity(static_cast<size_t>(capacity));
+                ++k;
+            } else if (std::strcmp(argv[k], SERVE_FLAG) == 0) {    // --serve <socket>, serve clients of a socket
+                if (k + 1 >= argc)
+                    throw InvalidFileArgumentsException();
+                socket_path = argv[++k];
+            } else if (std::strcmp(argv[k], WATCH_FLAG) == 0) {    // --watch <directory>, load the files that arrive
+                if (k + 1 >= argc)
+                    throw InvalidFileArgumentsException();
+                watch_directory = argv[++k];
             }
-            int timing = calculate_time_minutes(details.back().get_departure(), arrival_time);
-            if (timing == ARRIVAL_BEFORE_DEPARTURE) {
-                return line_number;
+        }
+        if (argFiles.empty() && snapshot_file.empty() && watch_directory.empty())
+            throw InvalidFileArgumentsException();
+        format = json ? ResultWriter::Format::JSON_LINES : ResultWriter::Format::TEXT;
+        writer = std::unique_ptr<ResultWriter>(new ResultWriter(std::cout, format,
+                                                                batch_file.empty() ? 0 : BATCH_BUFFER_SIZE));
+
+        if (!snapshot_file.empty())
+            Snapshot::restore(*graphs, snapshot_file);
+
+        if (!argFiles.empty()) {
+            const auto start = Stats::now();
+            parsed = IngestPool().parse(argFiles);          // Parse all files in parallel, insert in order.
+            stats->record("parse_batch", start);
+            const auto& first = parsed[0];
+            if (first.line_number == FILE_NOT_OPENED) {
+                throw InvalidInputExceptionExit(argFiles[0]);   // Could not open file
             }
-            int containers = std::stoi(container_quantity);
+            if (first.error)
+                std::rethrow_exception(first.error);
+            if (first.line_number != 0)
+                throw InvalidInputExceptionExit(argFiles[0] , first.line_number); // The First file must be valid
+            add_voyage(*graphs, first.voyage, first.file_name);
+        }
+    }catch (std::exception& e) {
+        std::cerr << e.what();
+        exit(1);
+    }
 
-            dest_ports.push_back(dest_port);
-            details.emplace_back(containers, timing, departure_time,dest_port);
+    writer->begin("-i");
+    for (size_t i = 1; i < parsed.size(); ++i) {        // Load all other files, can fail
+        try {
+            insert(*graphs, parsed[i], *writer);
+        }catch (std::exception& e) {
+            std::cerr << e.what();
         }
-        ++line_number;
     }
-    graphs->add_file(source_port, details, dest_ports);         // Insert all the file into the database.
-    file.close();
-    return 0;
-}
\ No newline at end of file
+    writer->end();
+
+    std::unique_ptr<SpoolWatcher> watcher;              // Stopped when the terminal, script or server ends.
+    if (!watch_directory.empty()) {
+        try {
+            graphs->prepare();                          // The first published version, batches publish the next ones.
+            concurrent = true;
+            watcher = std::unique_ptr<SpoolWatcher>(new SpoolWatcher(watch_directory,
+                [this](const std::vector<SpoolWatcher::Arrival>& arrivals) { ingest(arrivals); }));
+        }catch (std::exception& e) {
+            std::cerr << e.what();
+            exit(1);
+        }
+    }
+
+    if (batch_file.empty() && socket_path.empty()) {
+        start_terminal();
+        return;
+    }
+    try {
+        if (!socket_path.empty())
+            serve(socket_path);
+        else
+            run_batch(batch_file);
+    }catch (std::exception& e) {
+        std::cerr << e.what();
+        exit(1);
+    }
+}
+
+// Read_lines helper function, receives a file, and reads its contents into voyage via
+// The provided guidelines, (see Voyage::read) upon any error, return the line number that the error occurred in.
+// Otherwise returns 0.
+int Terminal::read_lines(const MappedFile& file, Voyage& voyage) const {
+    const auto start = Stats::now();
+    const int line_number = voyage.read(file.begin(), file.end());
+    stats->record("parse", start);
+    return line_number;
+}
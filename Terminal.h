@@ -1,14 +1,32 @@
 #ifndef TERMINAL_H
 #define TERMINAL_H
 
+#include <condition_variable>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <regex>
+#include <vector>
 #include "Graph.h"
+#include "IngestPool.h"
+#include "MappedFile.h"
+#include "QueryCache.h"
+#include "ResultWriter.h"
+#include "SpoolWatcher.h"
+#include "Stats.h"
 
 // Terminal.h simulates a simple terminal; written commands are executed, on any error, a unique exception is thrown.
 // Includes Graph<T> class, which is the database of graphs that is used throughout the project.
 #define DEFAULT_OUTPUT_FILE "output.dat"
+#define SNAPSHOT_FLAG "--snapshot"
+#define BATCH_FLAG "-b"
+#define JSON_FLAG "--json"
+#define CACHE_FLAG "--cache"
+#define SERVE_FLAG "--serve"
+#define WATCH_FLAG "--watch"
+#define BATCH_BUFFER_SIZE (1 << 20)     // Batch results are written in chunks of 1MB.
 template<typename T>
 class Graph;
 
@@ -18,23 +36,79 @@ class Graph;
  *  And checks for errors, then inserts all the data into the Graphs.
  *  Holds the graphs and the outputfile name.
  *
+ *  Server mode (--serve <socket>) answers the commands of many clients at once, a thread per client.
+ *  Queries read the latest published version of the graphs, (an immutable, fully compiled Graph held by a shared_ptr)
+ *  An update (load, restore) copies the latest version, applies itself to the copy and publishes it with an atomic swap,
+ *  So queries never wait for a load, and a version is freed when the last query reading it ends.
+ *  A version costs a copy of the whole graphs and a compile of all of them, (prepare) it grows with the size of the
+ *  graphs, not with the size of the change. Updates that arrive while another one is applied are therefore batched,
+ *  the next batch applies all of them to a single copy, compiled and published once, (see update) and a load of
+ *  many files, or a watch batch, is always a single update.
+ *  Queries of different clients share no lock: every session has its own results writer, query cache and stats recorder,
+ *  (see Stats::Recorder) the only shared writes of a query are the atomic load of the latest version and its reference
+ *  count, (std::atomic_load of a shared_ptr takes a short internal lock of the standard library, for the pointer copy)
+ *  So queries scale with the cores up to the contention on that reference count.
+ *  Watch mode (--watch <directory>) loads the files that arrive in a spool directory in the background, (see SpoolWatcher)
+ *  Every batch of files is a single update, published the same way, while the terminal, script or server keeps querying.
+ *  Outside server and watch mode there are no other readers, updates are applied in place.
+ *
  *  The big 3:
  *  Not implemented because this class uses smart pointers and standard library types only.
- *  Resource management is handled automatically by std::unique_ptr and std::string.
- *  No deep copying or custom cleanup logic is required,
+ *  Resource management is handled automatically by std::unique_ptr, std::shared_ptr and std::string.
+ *  Copying is deleted by the mutex, a Terminal is never copied,
  *  so the compiler-generated defaults are enough.
  * */
 class Terminal {
-    std::unique_ptr<Graph<std::string>> graphs;     // < Both graphs. (container, timing)
+    std::shared_ptr<Graph<std::string>> graphs;     // < Both graphs, (container, timing) the latest version.
+    std::unique_ptr<ResultWriter> writer;           // < Where query results go. (stdout, buffered)
+    ResultWriter::Format format = ResultWriter::Format::TEXT;   // < Format of the results.
     std::string output_file;                        // < outputfile.
+    QueryCache cache;                               // < Results of the latest queries.
+    std::unique_ptr<Stats> stats;                   // < Command latencies and ingest counters.
+    bool concurrent = false;                        // < Server mode, updates are copy-on-write.
+    std::mutex update_mutex;                        // < A single update, or output file, at a time.
+
+    // An update waiting for its batch. (server and watch mode)
+    struct PendingUpdate {
+        const std::function<void(Graph<std::string>&)>* apply;
+        std::exception_ptr error;                   // Thrown by apply, rethrown to its caller.
+        bool done;                                  // Applied and published, or failed.
+    };
+    std::mutex pending_mutex;                       // < Guards pending and updating.
+    std::condition_variable applied;                // < Notified at the end of every batch.
+    std::vector<PendingUpdate*> pending;            // < Updates waiting for the next batch.
+    bool updating = false;                          // < A batch is being applied.
+
+    void update(const std::function<void(Graph<std::string>&)>& apply);    // Applies a change to the graphs.
+    void apply_batch(const std::vector<PendingUpdate*>& batch);             // Publishes a version with a batch.
+    void add_voyage(Graph<std::string>& graph, const Voyage& voyage,
+                    const std::string& file_name) const;                // Inserts a parsed voyage, counted in stats.
+    void session(int client);                       // Runs the commands of a server client.
+    void ingest(const std::vector<SpoolWatcher::Arrival>& arrivals);   // Loads a batch of a watched directory.
 
 public:
     explicit Terminal();                            // Default ctor.
+    std::shared_ptr<const Graph<std::string>> snapshot() const;    // The latest version of the graphs.
     void start_terminal();                          // Starts the mini terminal.
-    void load(const char* file_name) const;         // Loads a file into the graphs.
-    void write_output_file();                       // Write the graphs into the outputfile.
+    void run_batch(const std::string& script_file); // Runs all commands of a script file.
+    void serve(const std::string& socket_path);     // Runs the commands of many clients of a socket.
+    void load(const char* file_name, ResultWriter& results);          // Loads a file into the graphs.
+    void load_files(const std::vector<std::string>& file_names, ResultWriter& results,
+                    bool replace = false);                              // Loads many files.
+    void unload(const std::string& file_name, ResultWriter& results);       // Removes a loaded file from the graphs.
+    void insert(Graph<std::string>& graph, const IngestPool::ParsedFile& parsed,
+                ResultWriter& results, bool replace = false) const;     // Inserts a parsed file into graph.
+    void write_output_file(const std::string& file_name);   // Write the graphs into file_name, or the outputfile.
+    void write_balances(const std::string& date, const std::string& file_name,
+                        ResultWriter& results) const;                   // Balance of every port.
+    void write_stats(ResultWriter& results, const QueryCache& query_cache) const;   // Writes all stats as results.
+    void save(const std::string& file_name, ResultWriter& results) const;   // Saves the graphs into a snapshot file.
+    void restore(const std::string& file_name, ResultWriter& results);      // Replaces the graphs with a snapshot.
+    void archive(const std::string& file_name, ResultWriter& results) const;    // Saves the voyages into an archive.
+    void load_archive(const std::string& file_name, ResultWriter& results);     // Loads the voyages of an archive.
+    void history(const std::string& file_name, ResultWriter& results);          // Opens an archive as history.
     void read_files(int argc, char *argv[]);        // Initialization stage.
-    int read_lines(std::ifstream &file) const;      // Read all lines from 1 file.
+    int read_lines(const MappedFile &file, Voyage& voyage) const;  // Read all lines from 1 file.
 };
 
-#endif //TERMINAL_H
\ No newline at end of file
+#endif //TERMINAL_H
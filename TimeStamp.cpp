@@ -0,0 +1,53 @@
+#include "TimeStamp.h"
+
+static constexpr bool LEAP_YEAR = YEAR % 4 == 0 && (YEAR % 100 != 0 || YEAR % 400 == 0);
+static constexpr int DAYS_PER_MONTH[12] = {31, LEAP_YEAR ? 29 : 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+static constexpr int DAYS_IN_YEAR = LEAP_YEAR ? 366 : 365;
+
+// Days passed before the first day of month (0 based), C++11 constexpr allows a single return only.
+static constexpr int days_before(const int month) {
+    return month == 0 ? 0 : days_before(month - 1) + DAYS_PER_MONTH[month - 1];
+}
+static constexpr int DAYS_BEFORE_MONTH[12] = {
+    days_before(0), days_before(1), days_before(2), days_before(3), days_before(4), days_before(5),
+    days_before(6), days_before(7), days_before(8), days_before(9), days_before(10), days_before(11)
+};
+
+// Reads 2 digits starting at text, returns -1 if one of them is not a digit.
+static int two_digits(const char* text) {
+    if (text[0] < '0' || text[0] > '9' || text[1] < '0' || text[1] > '9') return -1;
+    return (text[0] - '0') * 10 + (text[1] - '0');
+}
+
+bool TimeStamp::parse(const char* text, const size_t length, TimeStamp& out) {
+    if (length != DATE_LENGTH || text[2] != '/' || text[5] != ' ' || text[8] != ':') return false;
+
+    return from_fields(two_digits(text), two_digits(text + 3), two_digits(text + 6), two_digits(text + 9), out);
+}
+
+bool TimeStamp::from_fields(const int day, const int month, const int hour, const int minute, TimeStamp& out) {
+    if (month < 1 || month > 12 || day < 1 || day > DAYS_PER_MONTH[month - 1]) return false;
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59) return false;
+
+    out.minutes = (DAYS_BEFORE_MONTH[month - 1] + day - 1) * MINUTES_IN_DAY + hour * MINUTES + minute;
+    return true;
+}
+
+bool TimeStamp::parse(const std::string& text, TimeStamp& out) {
+    return parse(text.data(), text.size(), out);
+}
+
+std::string TimeStamp::format() const {
+    int day = minutes / MINUTES_IN_DAY % DAYS_IN_YEAR;      // Dates past the end of YEAR wrap to the next January.
+    int month = 0;
+    while (day >= DAYS_PER_MONTH[month]) day -= DAYS_PER_MONTH[month++];
+
+    const int hour = minutes % MINUTES_IN_DAY / MINUTES, minute = minutes % MINUTES;
+    const char text[DATE_LENGTH + 1] = {
+        static_cast<char>('0' + (day + 1) / 10), static_cast<char>('0' + (day + 1) % 10), '/',
+        static_cast<char>('0' + (month + 1) / 10), static_cast<char>('0' + (month + 1) % 10), ' ',
+        static_cast<char>('0' + hour / 10), static_cast<char>('0' + hour % 10), ':',
+        static_cast<char>('0' + minute / 10), static_cast<char>('0' + minute % 10), '\0'
+    };
+    return std::string(text, DATE_LENGTH);
+}
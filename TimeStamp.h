@@ -0,0 +1,54 @@
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// All dates belong to a single fixed year, so a date is the number of minutes since 01/01 00:00 of that year.
+#define YEAR 2023
+#define MINUTES 60
+#define MINUTES_IN_DAY (24 * MINUTES)
+#define DATE_LENGTH 11  // dd/mm HH:mm
+
+/**
+ *  TimeStamp class
+ *  This class represents a "dd/mm HH:mm" date as minutes since the start of YEAR.
+ *  Parsing and formatting are pure arithmetic, there is no std::tm, mktime or localtime involved,
+ *  So the results do not depend on the locale or timezone and the functions are thread-safe.
+ *  Comparing 2 dates is a single integer compare.
+ *
+ *  The big 3:
+ *  Not implemented because this class only holds a single integer,
+ *  the compiler-generated versions are enough.
+ ***/
+class TimeStamp {
+    int32_t minutes = 0;        // Minutes since 01/01 00:00.
+
+public:
+    TimeStamp() = default;
+    explicit TimeStamp(const int32_t _minutes) : minutes(_minutes) {}
+
+    // Parses a "dd/mm HH:mm" date, returns false if the shape or any of the fields are not valid in YEAR.
+    static bool parse(const char* text, size_t length, TimeStamp& out);
+    static bool parse(const std::string& text, TimeStamp& out);
+
+    // Builds a date from its fields, returns false if any of them is not valid in YEAR. (-1 for a field that is not
+    // 2 digits) The range checks of parse, shared with the vectorized parsers. (see LineScanner)
+    static bool from_fields(int day, int month, int hour, int minute, TimeStamp& out);
+
+    std::string format() const;                                         // Returns "dd/mm HH:mm".
+    int32_t get_minutes() const { return minutes; }                     // Minutes getter.
+
+    TimeStamp operator+(const int _minutes) const { return TimeStamp(minutes + _minutes); }
+    int operator-(const TimeStamp& other) const { return minutes - other.minutes; }    // Difference in minutes.
+
+    bool operator==(const TimeStamp& other) const { return minutes == other.minutes; }
+    bool operator!=(const TimeStamp& other) const { return minutes != other.minutes; }
+    bool operator<(const TimeStamp& other) const { return minutes < other.minutes; }
+    bool operator<=(const TimeStamp& other) const { return minutes <= other.minutes; }
+    bool operator>(const TimeStamp& other) const { return minutes > other.minutes; }
+    bool operator>=(const TimeStamp& other) const { return minutes >= other.minutes; }
+};
+
+#endif //TIMESTAMP_H
@@ -0,0 +1,105 @@
+#include "Timeline.h"
+#include <algorithm>
+
+// Orders events by time only, so events at the same time keep their insertion order.
+static bool earlier(const std::pair<TimeStamp, int>& a, const std::pair<TimeStamp, int>& b) {
+    return a.first < b.first;
+}
+
+// Lowest set bit of i, the number of events a tree node covers.
+static size_t lowbit(const size_t i) {
+    return i & (~i + 1);
+}
+
+int Timeline::prefix_sum(size_t count) const {
+    int sum = 0;
+    for (; count > 0; count -= lowbit(count))
+        sum += tree[count];
+    return sum;
+}
+
+void Timeline::add_delta(const size_t index, const int delta) {
+    for (size_t i = index + 1; i < tree.size(); i += lowbit(i))
+        tree[i] += delta;
+}
+
+void Timeline::push_tree(const int delta) const {
+    const size_t i = tree.size();                       // 1 based node of the new event.
+    tree.push_back(delta + prefix_sum(i - 1) - prefix_sum(i - lowbit(i)));
+}
+
+void Timeline::rebuild() const {
+    tree.assign(events.size() + 1, 0);
+    for (size_t i = 1; i < tree.size(); ++i) {
+        tree[i] += events[i - 1].second;
+        const size_t parent = i + lowbit(i);
+        if (parent < tree.size()) tree[parent] += tree[i];
+    }
+}
+
+void Timeline::add_event(const TimeStamp time, const int delta) {
+    pending.emplace_back(time, delta);
+}
+
+void Timeline::remove_event(const TimeStamp time, const int delta) {
+    commit();
+    const auto range = std::equal_range(events.begin(), events.end(), std::make_pair(time, delta), earlier);
+    auto event = range.second;
+    while (event != range.first && (--event)->second != delta) {}      // The latest one, same as loading order.
+    if (event == range.second || event->second != delta) return;
+    event->second = 0;                                                  // A 0 event changes no balance.
+    add_delta(static_cast<size_t>(event - events.begin()), -delta);
+    if (++tombstones * 2 <= events.size()) return;
+
+    // Erases the tombstones, (and events that were 0 from the start, they do not change any balance either)
+    events.erase(std::remove_if(events.begin(), events.end(),
+                                [](const std::pair<TimeStamp, int>& e) { return e.second == 0; }),
+                 events.end());
+    tombstones = 0;
+    rebuild();
+}
+
+void Timeline::commit() const {
+    if (pending.empty()) return;
+    std::stable_sort(pending.begin(), pending.end(), earlier);
+
+    // Only the suffix from the first pending time onwards moves, loads in time order cost O(pending log events).
+    const auto first = std::upper_bound(events.begin(), events.end(), pending.front(), earlier);
+    const size_t from = first - events.begin();
+
+    const size_t middle = events.size();
+    events.insert(events.end(), pending.begin(), pending.end());
+    if (tree.empty()) tree.push_back(0);                // Node 0 is never used.
+    if (from == middle) {
+        for (const auto& event : pending) push_tree(event.second);
+    }else {
+        std::inplace_merge(events.begin() + from, events.begin() + middle, events.end(), earlier);
+        rebuild();
+    }
+    pending.clear();
+}
+
+int Timeline::balance_at(const TimeStamp time) const {
+    commit();
+    const auto last = std::upper_bound(events.begin(), events.end(), time,
+        [](const TimeStamp t, const std::pair<TimeStamp, int>& event) { return t < event.first; });
+    return prefix_sum(static_cast<size_t>(last - events.begin()));
+}
+
+void Timeline::balance_series(const TimeStamp from, const TimeStamp to, const int step,
+                              std::vector<int>& balances) const {
+    balances.clear();
+    if (step <= 0 || to < from) return;
+    commit();
+
+    // Binary search the first sample only, the following samples move forward over the events.
+    size_t next = std::upper_bound(events.begin(), events.end(), from,
+        [](const TimeStamp t, const std::pair<TimeStamp, int>& event) { return t < event.first; }) - events.begin();
+    int balance = prefix_sum(next);
+
+    for (long long time = from.get_minutes(); time <= to.get_minutes(); time += step) {
+        for (; next < events.size() && events[next].first.get_minutes() <= time; ++next)
+            balance += events[next].second;
+        balances.push_back(balance);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <utility>
+#include <vector>
+#include "TimeStamp.h"
+
+/**
+ *  Timeline class
+ *  This class represents the container events of a single port, sorted by time.
+ *  Every event is either an arrival (+containers) or a departure (-containers),
+ *  The deltas are also kept in a Fenwick (binary indexed) tree, so the balance at any time is a binary search and
+ *  a prefix sum of O(log events), and a single delta can change in O(log events).
+ *  New events are pending until the next read, removal or commit, which merges all of them at once: events merged after
+ *  the last one are added to the tree one by one, any other merge rebuilds it, (O(events)) so a load of many files out
+ *  of time order (or a watch batch) costs a single merge and rebuild per port, not one per voyage.
+ *  The merge of a read changes the mutable members, so a timeline read by many threads must be committed first.
+ *  (see Graph::prepare)
+ *  An event of an unloaded voyage is not erased, its delta becomes 0 (a tombstone) in O(log events),
+ *  The tombstones are erased together once they are half of the events, so a removal is O(log events) amortized.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers and value types,
+ *  the compiler-generated versions are enough.
+ ***/
+class Timeline {
+    mutable std::vector<std::pair<TimeStamp, int>> events;  // Sorted (time, containers delta) events.
+    mutable std::vector<int> tree;                      // Fenwick tree of the deltas, tree[i] covers events (i - lowbit(i), i].
+    mutable std::vector<std::pair<TimeStamp, int>> pending;     // Events added since the last commit.
+    size_t tombstones = 0;                              // Removed events still in events.
+
+    int prefix_sum(size_t count) const;                 // Sum of the deltas of the first count events.
+    void add_delta(size_t index, int delta);            // Adds delta to event index in the tree.
+    void push_tree(int delta) const;                    // Adds the tree node of a new last event.
+    void rebuild() const;                               // Builds the tree of all events. (O(events))
+
+public:
+    void add_event(TimeStamp time, int delta);          // Adds an event, merged by the next commit.
+    void remove_event(TimeStamp time, int delta);       // Removes an event added before.
+    void commit() const;                                // Merges the pending events into the timeline.
+    int balance_at(TimeStamp time) const;               // Sum of all deltas up to (and including) time.
+
+    // Fills balances with balance_at(from), balance_at(from + step) ... up to to, in a single walk over the events.
+    void balance_series(TimeStamp from, TimeStamp to, int step, std::vector<int>& balances) const;
+    // Events getter, (committed first) removed events are still there with a 0 delta until they are compacted.
+    const std::vector<std::pair<TimeStamp, int>>& get_events() const {
+        commit();
+        return events;
+    }
+};
+
+#endif //TIMELINE_H
@@ -0,0 +1,97 @@
+#ifndef TRAFFICINDEX_H
+#define TRAFFICINDEX_H
+
+#include <cstddef>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Totals of a single port or lane.
+struct Traffic {
+    long long containers = 0;   // Containers loaded and unloaded.
+    long long voyages = 0;      // Voyages that used it.
+};
+
+/**
+ *  Generic TrafficIndex class
+ *  This class keeps the Traffic totals of every key (a port id, or a lane key) and 2 rankings of the keys,
+ *  one by containers and one by voyages, each as an ordered set of (total, key), biggest total first.
+ *  Adding to the totals of a key is O(1), the key is only marked changed, and refresh() moves every changed key
+ *  in both sets once, O(log n) per key, no matter how many voyages changed it. (a hub port is ranked once per load,
+ *  not once per voyage) After a refresh the top k keys are the first k entries of a set, read without scanning.
+ *  Ties are ranked by the smaller key first, a key whose voyages drop to 0 leaves the index.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers,
+ *  the compiler-generated versions are enough.
+ ***/
+template<typename K>
+class TrafficIndex {
+    // Biggest total first, then the smaller key.
+    struct Ranking {
+        bool operator()(const std::pair<long long, K>& a, const std::pair<long long, K>& b) const {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        }
+    };
+    using RankedSet = std::set<std::pair<long long, K>, Ranking>;
+
+    struct Entry {
+        Traffic traffic;                // Current totals.
+        Traffic ranked;                 // Totals the key is ranked by, until the next refresh.
+        bool is_ranked = false;         // In the sets.
+        bool changed = false;           // In changed.
+    };
+
+    std::unordered_map<K, Entry> entries;       // Key -> its totals.
+    RankedSet by_containers;                    // Keys ranked by containers.
+    RankedSet by_voyages;                       // Keys ranked by voyages.
+    std::vector<K> changed;                     // Keys added to since the last refresh.
+
+public:
+    // Adds containers and voyages (negative to take them out again) to the totals of key.
+    void add(const K key, const long long containers, const long long voyages) {
+        Entry& entry = entries[key];
+        entry.traffic.containers += containers;
+        entry.traffic.voyages += voyages;
+        if (!entry.changed) {
+            entry.changed = true;
+            changed.push_back(key);
+        }
+    }
+
+    // Ranks every changed key by its current totals.
+    void refresh() {
+        for (const K key : changed) {
+            const auto found = entries.find(key);
+            Entry& entry = found->second;
+            if (entry.is_ranked) {
+                by_containers.erase(std::make_pair(entry.ranked.containers, key));
+                by_voyages.erase(std::make_pair(entry.ranked.voyages, key));
+            }
+            if (entry.traffic.voyages <= 0) {
+                entries.erase(found);
+                continue;
+            }
+            entry.ranked = entry.traffic;
+            entry.is_ranked = true;
+            entry.changed = false;
+            by_containers.emplace(entry.ranked.containers, key);
+            by_voyages.emplace(entry.ranked.voyages, key);
+        }
+        changed.clear();
+    }
+
+    // Fills keys with the (at most) k keys of the largest totals, by voyages or by containers, as of the last refresh.
+    void top(const size_t k, const bool voyages, std::vector<K>& keys) const {
+        keys.clear();
+        const RankedSet& ranking = voyages ? by_voyages : by_containers;
+        for (auto entry = ranking.begin(); entry != ranking.end() && keys.size() < k; ++entry)
+            keys.push_back(entry->second);
+    }
+
+    const Traffic& get(const K key) const { return entries.at(key).ranked; }   // Totals of a ranked key.
+    bool is_fresh() const { return changed.empty(); }                           // No change since the last refresh.
+};
+
+#endif //TRAFFICINDEX_H
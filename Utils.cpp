@@ -1,8 +1,11 @@
 #include "Utils.h"
-#include <iomanip>
+#include "ResultWriter.h"
+#include <algorithm>
+#include <climits>
+#include <glob.h>
 #include <iostream>
 #include <regex>
-#include <ctime>
+#include <sstream>
 
 std::vector<std::string> split_line(const std::string& line){
     std::vector<std::string> tokens;
@@ -15,6 +18,36 @@ std::vector<std::string> split_line(const std::string& line){
     return tokens;
 }
 
+std::vector<std::string> split_words(const std::string& line) {
+    std::vector<std::string> words;
+    std::istringstream iss(line);
+    std::string word;
+
+    while (iss >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+bool is_glob(const std::string& file_name) {
+    return file_name.find_first_of("*?[") != std::string::npos;
+}
+
+std::vector<std::string> expand_files(const std::vector<std::string>& file_names) {
+    std::vector<std::string> files;
+    for (const auto& name : file_names) {
+        glob_t matches;
+        if (is_glob(name) && glob(name.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; ++i)
+                files.emplace_back(matches.gl_pathv[i]);
+            globfree(&matches);
+        } else {
+            files.push_back(name);
+        }
+    }
+    return files;
+}
+
 bool is_valid_port(const std::string& port) {
     return !port.empty() && port.length() <= MAX_STRING_LENGTH;
 }
@@ -23,27 +56,25 @@ bool is_number(const std::string& s) {
     return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit);
 }
 
-bool isValidDateTime(const std::string& input) {
-    std::tm tm = {};
-    std::istringstream stream(input);
-    stream >> std::get_time(&tm, TIME_PATTERN);
-
-    if (stream.fail()) {
-        return false;
+bool scan_number(const char* text, const size_t length, int& number) {
+    if (length == 0) return false;
+    long long value = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        value = value * 10 + (text[i] - '0');
+        if (value > INT_MAX) return false;
     }
+    number = static_cast<int>(value);
+    return true;
+}
 
-    tm.tm_year = YEAR - LOWER_YEAR;
-    const std::tm original = tm;
-    std::mktime(&tm);
-
-    return original.tm_mday == tm.tm_mday &&
-           original.tm_mon  == tm.tm_mon &&
-           original.tm_hour == tm.tm_hour &&
-           original.tm_min  == tm.tm_min;
+bool isValidDateTime(const std::string& input) {
+    TimeStamp time;
+    return TimeStamp::parse(input, time);
 }
 
 bool matchesDateTime(const std::string& input1, const std::string& input2){
-    const std::regex pattern(REGEX_PATTERN);
+    static const std::regex pattern(REGEX_PATTERN);    // Compiled once, matching is thread-safe.
     if (!std::regex_match(input1, pattern) || !std::regex_match(input2, pattern))
         return false;
     return isValidDateTime(input1) && isValidDateTime(input2);
@@ -56,46 +87,53 @@ bool check_input(const std::string& dest_port, const std::string& arrival_time,
     return false;
 }
 
-int calculate_time_minutes(const std::string &input1, const std::string &input2) {
-    std::tm tm1 = {}, tm2 = {};
-
-    std::istringstream stream1(input1);
-    std::istringstream stream2(input2);
-
-    stream1 >> std::get_time(&tm1, TIME_PATTERN);
-    stream2 >> std::get_time(&tm2, TIME_PATTERN);
-
-    tm1.tm_year = tm2.tm_year = YEAR - LOWER_YEAR;
-
-    time_t time1 = std::mktime(&tm1);
-    time_t time2 = std::mktime(&tm2);
-
-    const int diffMinutes = static_cast<int>(std::difftime(time2,time1) / MINUTES);
+int calculate_time_minutes(const TimeStamp& input1, const TimeStamp& input2) {
+    const int diffMinutes = input2 - input1;
     if (diffMinutes < 0)
         return -1;
     return diffMinutes;
 }
 
-std::tm datetime(const std::string &_datetime) {
-    std::tm tm = {};
-    std::istringstream stream(_datetime);
-    stream >> std::get_time(&tm, TIME_PATTERN);
-    tm.tm_year = YEAR - LOWER_YEAR;
-    return tm;
+TimeStamp datetime(const std::string &_datetime) {
+    TimeStamp time;
+    TimeStamp::parse(_datetime, time);
+    return time;
 }
 
-std::string format_time(const std::time_t& _time) {
-    std::ostringstream oss;
-    oss << std::put_time(std::localtime(&_time), TIME_PATTERN);
-    return oss.str();
+std::string format_time(const TimeStamp& _time) {
+    return _time.format();
+}
+
+uint64_t checksum(const char* data, const size_t size, uint64_t hash) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
 }
 
-void printError() {
-    std::cerr << "USAGE:\n"
-              << "'load' <file> *or*\n"
-              << "<node>, 'inbound' *or*\n"
-              << "<node>, 'outbound' *or*\n"
-              << "<node>, 'balance', dd/mm HH:mm *or*\n"
-              << "'print' *or*\n"
-              << "'exit' *to terminate*\n";
+void printError(ResultWriter& writer) {
+    static const std::string usage = std::string("USAGE:\n")
+                                     + "'load' <file> [<file> ...] *or*\n"
+                                     + "'unload' <file> *or*\n"
+                                     + "<node>, 'inbound' *or*\n"
+                                     + "<node>, 'outbound' *or*\n"
+                                     + "<node>, 'balance', dd/mm HH:mm *or*\n"
+                                     + "<node>, 'balance_series', dd/mm HH:mm, dd/mm HH:mm, <minutes> *or*\n"
+                                     + "<node>, 'route', <node> *or*\n"
+                                     + "<node>, 'earliest', <node>, dd/mm HH:mm *or*\n"
+                                     + "<node>, 'maxflow', <node> *or*\n"
+                                     + "'balances', dd/mm HH:mm [, <file>] *or*\n"
+                                     + "'top_ports', <k> [, containers|voyages] *or*\n"
+                                     + "'top_routes', <k> [, containers|voyages] *or*\n"
+                                     + "'print' [<file>] *or*\n"
+                                     + "'cache' *or*\n"
+                                     + "'stats' *or*\n"
+                                     + "'save' <file> *or*\n"
+                                     + "'restore' <file> *or*\n"
+                                     + "'archive' <file> *or*\n"
+                                     + "'load_archive' <file> *or*\n"
+                                     + "'history' <file> *or*\n"
+                                     + "'exit' *to terminate*\n";
+    writer.error(usage);
 }
\ No newline at end of file
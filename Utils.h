@@ -1,10 +1,13 @@
 #ifndef UTILLS_H
 #define UTILLS_H
 
-#include <ctime>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "Node.h"
+#include "TimeStamp.h"
+
+class ResultWriter;
 
 /**
  *  Welcome to the Utils helper functions file!
@@ -13,22 +16,34 @@
  ***/
 
 // All the constants below are used to check if the date provided is valid and port name validation.
-#define YEAR 2023
-#define LOWER_YEAR 1900
-#define MINUTES 60
 #define MAX_STRING_LENGTH 16
-#define TIME_PATTERN "%d/%m %H:%M"
 #define REGEX_PATTERN R"(^\d{2}/\d{2} \d{2}:\d{2}$)"
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
 
 // Splits a string into 2 or 4 words via ','.
 std::vector<std::string> split_line(const std::string& line);
 
+// Splits a string into words via whitespace.
+std::vector<std::string> split_words(const std::string& line);
+
+// Check if a file name is a glob pattern. (contains *, ? or [)
+bool is_glob(const std::string& file_name);
+
+// Replaces every glob pattern with the files matching it, sorted by name.
+// A pattern that matches nothing is kept as is, so loading it reports the missing file.
+std::vector<std::string> expand_files(const std::vector<std::string>& file_names);
+
 // Check if the name of port is valid, returns true if valid, false otherwise.
 bool is_valid_port(const std::string& port);
 
 // Check if a string is a valid number, return true if valid, false otherwise.
 bool is_number(const std::string& s);
 
+// Hand-written version of is_number + std::stoi, used by the file parser, reads the number without allocating.
+// Returns false if the text is not a valid number, or does not fit in an int.
+bool scan_number(const char* text, size_t length, int& number);
+
 // Check if the date is valid. (regex)
 // return true if date string is valid, false otherwise.
 bool isValidDateTime(const std::string& input);
@@ -41,19 +56,22 @@ bool matchesDateTime(const std::string& input1, const std::string& input2);
 bool check_input(const std::string& dest_port, const std::string& arrival_time, const std::string& container_quantity,
     const std::string& departure_time);
 
-// Receives 2 dates via string, and returns the amount of minute difference between input1 to input2.
-// If the difference is negative, 0 is returned.
-int calculate_time_minutes(const std::string &input1, const std::string &input2);
+// Receives 2 dates, and returns the amount of minute difference between input1 to input2.
+// If the difference is negative, -1 is returned.
+int calculate_time_minutes(const TimeStamp& input1, const TimeStamp& input2);
 
-// Receives a string representation of time; and std::tm returned of said time,
+// Receives a valid string representation of time, and returns it as a TimeStamp,
 // Via the assumption year given in exercise -> 2023
-std::tm datetime(const std::string& _datetime);
+TimeStamp datetime(const std::string& _datetime);
 
-// Receives time_t& and returns a string representation of said time.
+// Receives a TimeStamp and returns a string representation of said time.
 // Returned string example 11/05 10:48.
-std::string format_time(const std::time_t& _time);
+std::string format_time(const TimeStamp& _time);
+
+// FNV-1a 64 bit hash of size bytes, the checksum of snapshot and archive files, continues hash if one is given.
+uint64_t checksum(const char* data, size_t size, uint64_t hash = FNV_OFFSET);
 
-// Print into cerr the error message upon a bad terminal input.
-void printError();
+// Writes the usage message as an error of writer upon a bad terminal input. (std::cerr, or back to a server client)
+void printError(ResultWriter& writer);
 
 #endif //UTILLS_H
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "Voyage.h"
+#include "Utils.h"
+
+#define SOURCE_TOKENS 2         // <port_name>,<departure_time>
+#define LEG_TOKENS 4            // <port_name>,<arrival_time>,<container_quantity>,<departure_time>
+
+// A piece of a line inside the mapped file, nothing is copied until a port name is stored.
+struct Token {
+    const char* data;
+    size_t size;
+};
+
+// Same rules as is_valid_port in Utils.h.
+static bool valid_port(const Token& port) {
+    return port.size != 0 && port.size <= MAX_STRING_LENGTH;
+}
+
+// The separators of the whole file are found first, then every line is split and checked by the kernels of scanner.
+int Voyage::read(const char* begin, const char* end, const LineScanner& scanner) {
+    static thread_local std::vector<size_t> separators;     // Reused by every file parsed on the thread.
+    scanner.separators(begin, end, separators);
+    Token tokens[LEG_TOKENS + 1];
+    int line_number = 1;
+    size_t next = 0;                                // First separator of the line.
+
+    for (const char* line = begin; line != end; ++line_number) {
+        // Splits the line via ',' exactly like std::getline(stream, token, ',') does, an empty line has no tokens,
+        // And a ',' at the end of the line does not start a new token. Up to LEG_TOKENS + 1 tokens are stored,
+        // that's enough to know a line has too many.
+        size_t count = 0;
+        const char* token = line;
+        for (; next < separators.size() && begin[separators[next]] == ','; ++next) {
+            const char* comma = begin + separators[next];
+            if (count <= LEG_TOKENS) tokens[count++] = Token{token, static_cast<size_t>(comma - token)};
+            token = comma + 1;
+        }
+        const char* line_end = next < separators.size() ? begin + separators[next++] : end;
+        if (token != line_end && count <= LEG_TOKENS) tokens[count++] = Token{token, static_cast<size_t>(line_end - token)};
+        line = line_end == end ? end : line_end + 1;
+
+        if (details.empty()) {                      // source port at the first line of each file. (2 words)
+            TimeStamp departure;
+            if (count != SOURCE_TOKENS || !valid_port(tokens[0]) ||
+                !scanner.dates(tokens[1].data, tokens[1].size, nullptr, 0, end, departure, departure)) {
+                return line_number;
+            }
+            source.assign(tokens[0].data, tokens[0].size);
+            details.emplace_back(0,0,departure,source);
+        }
+        else {                                      // All lines after the source port. (4 words)
+            TimeStamp arrival, departure;
+            int containers = 0;
+            if (count != LEG_TOKENS || !valid_port(tokens[0]) ||
+                !scanner.number(tokens[2].data, tokens[2].size, end, containers) ||
+                !scanner.dates(tokens[1].data, tokens[1].size, tokens[3].data, tokens[3].size, end, arrival, departure)) {
+                return line_number;
+            }
+            const int timing = calculate_time_minutes(details.back().get_departure(), arrival);
+            if (timing < 0) {                       // Arrival of a boat before the previous boat departed.
+                return line_number;
+            }
+            destinations.emplace_back(tokens[0].data, tokens[0].size);
+            details.emplace_back(containers, timing, departure, destinations.back());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef VOYAGE_H
+#define VOYAGE_H
+
+#include <string>
+#include <vector>
+#include "LineScanner.h"
+#include "SailDetails.h"
+
+/**
+ *  Voyage class
+ *  This class represents the parsed contents of a single input file (one ship journey),
+ *  Before it is inserted into the Graph.
+ *  The file is parsed in place (see MappedFile), lines and fields are scanned by vectorized kernels, (see LineScanner)
+ *  without std::getline, std::istringstream, std::regex or a std::string per field.
+ *  Parsing does not touch the Graph, so many files can be parsed at the same time, (see IngestPool)
+ *  and inserted later in a deterministic order via Graph::add_file.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers,
+ *  the compiler-generated versions are enough.
+ ***/
+class Voyage {
+    std::string source;                         // Source port, first line of the file.
+    std::vector<SailDetails> details;           // details[0] is the departure from source, one entry per line.
+    std::vector<std::string> destinations;      // Destination port of every line after the first.
+
+public:
+    // Reads all lines from file, checks the dates provided, and the non-negative container count,
+    // And the amounts of data in a single line, upon any error, return the line number that the error occurred in.
+    // Returns 0 if the whole file is valid. Every kernel of scanner gives the same result.
+    int read(const char* begin, const char* end, const LineScanner& scanner = LineScanner::get());
+
+    const std::string& get_source() const { return source; }                          // Source getter.
+    const std::vector<SailDetails>& get_details() const { return details; }           // Details getter.
+    const std::vector<std::string>& get_destinations() const { return destinations; } // Destinations getter.
+};
+
+#endif //VOYAGE_H
@@ -0,0 +1,430 @@
+#include "VoyageArchive.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include "FileException.h"
+#include "MappedFile.h"
+#include "Utils.h"
+
+#define VARINT_BITS 7
+#define VARINT_MORE 0x80
+
+// The fixed size header of the file.
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t payload_size;
+    uint64_t checksum;
+};
+
+// Appends value as a varint, 7 bits per byte, lowest bits first.
+static void put_varint(std::vector<uint8_t>& bytes, uint32_t value) {
+    while (value >= VARINT_MORE) {
+        bytes.push_back(static_cast<uint8_t>(value | VARINT_MORE));
+        value >>= VARINT_BITS;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// Appends value as a zigzag varint, so values close to 0 take a single byte, negative or not.
+static void put_signed(std::vector<uint8_t>& bytes, const int32_t value) {
+    put_varint(bytes, (static_cast<uint32_t>(value) << 1) ^ (value < 0 ? UINT32_MAX : 0));
+}
+
+// Reads varints back from a block, every read is bounds checked.
+class ArchiveReader {
+    const uint8_t* position;
+    const uint8_t* end;
+    bool valid = true;
+
+public:
+    ArchiveReader(const uint8_t* _begin, const uint8_t* _end) : position(_begin), end(_end) {}
+
+    uint32_t get() {
+        uint32_t value = 0;
+        for (int shift = 0; position != end && shift < 32; shift += VARINT_BITS) {
+            const uint8_t byte = *position++;
+            value |= static_cast<uint32_t>(byte & (VARINT_MORE - 1)) << shift;
+            if (byte < VARINT_MORE) return value;
+        }
+        valid = false;                      // Truncated, or longer than 5 bytes.
+        return 0;
+    }
+
+    int32_t get_signed() {
+        const uint32_t value = get();
+        return static_cast<int32_t>((value >> 1) ^ (0U - (value & 1)));
+    }
+
+    bool is_valid() const { return valid; }
+    bool at_end() const { return valid && position == end; }
+};
+
+// Appends count values to the payload.
+template<typename V>
+static void put_array(std::vector<char>& bytes, const V* values, const size_t count) {
+    const char* raw = reinterpret_cast<const char*>(values);
+    bytes.insert(bytes.end(), raw, raw + count * sizeof(V));
+}
+
+// Reads count values from the payload, false if it is too short.
+template<typename V>
+static bool get_array(const char*& position, const char* end, std::vector<V>& values, const size_t count) {
+    if (static_cast<size_t>(end - position) / sizeof(V) < count) return false;
+    values.resize(count);
+    std::memcpy(values.data(), position, count * sizeof(V));
+    position += count * sizeof(V);
+    return true;
+}
+
+void VoyageArchive::build(const VoyageStore& store, const std::vector<std::string>& port_names) {
+    std::vector<uint32_t> order;                    // Voyage indexes, by departure, empty files have nothing to keep.
+    for (size_t v = 0; v < store.size(); ++v)
+        if (!store.is_removed(v) && store.begin(v) != store.end(v)) order.push_back(static_cast<uint32_t>(v));
+    std::stable_sort(order.begin(), order.end(), [&store](const uint32_t a, const uint32_t b) {
+        return store.get_departure(store.begin(a)) < store.get_departure(store.begin(b));
+    });
+
+    // Only ports of archived voyages get an archive id, in order of appearance.
+    std::vector<uint32_t> dictionary(port_names.size(), NO_PORT);
+    names.clear();
+    const auto archive_id = [&](const uint32_t port) {
+        if (dictionary[port] == NO_PORT) {
+            dictionary[port] = static_cast<uint32_t>(names.size());
+            names.push_back(port_names[port]);
+        }
+        return dictionary[port];
+    };
+
+    blocks.clear();
+    data.clear();
+    std::vector<PortSummary> events;
+    for (size_t first = 0; first < order.size(); first += ARCHIVE_BLOCK_VOYAGES) {
+        const size_t last = std::min(order.size(), first + ARCHIVE_BLOCK_VOYAGES);
+        Block block{INT32_MAX, INT32_MIN, static_cast<uint32_t>(last - first), static_cast<uint32_t>(data.size()), 0, 0};
+
+        events.clear();
+        for (size_t i = first; i < last; ++i)
+            store.for_each_event(order[i], [&](const uint32_t port, const TimeStamp time, const int delta) {
+                block.min_time = std::min(block.min_time, time.get_minutes());
+                block.max_time = std::max(block.max_time, time.get_minutes());
+                events.push_back(PortSummary{archive_id(port), delta, time.get_minutes(), time.get_minutes()});
+            });
+        std::sort(events.begin(), events.end(),
+                  [](const PortSummary& a, const PortSummary& b) { return a.port < b.port; });
+        size_t ports = 0;                           // Merge the events of every port.
+        for (const PortSummary& event : events) {
+            if (ports == 0 || events[ports - 1].port != event.port) {
+                events[ports++] = event;
+                continue;
+            }
+            PortSummary& merged = events[ports - 1];
+            merged.delta += event.delta;
+            merged.min_time = std::min(merged.min_time, event.min_time);
+            merged.max_time = std::max(merged.max_time, event.max_time);
+        }
+        events.resize(ports);
+
+        put_varint(data, static_cast<uint32_t>(events.size()));
+        uint32_t previous_port = 0;
+        for (const PortSummary& port : events) {
+            put_varint(data, port.port - previous_port);
+            put_signed(data, port.delta);
+            put_varint(data, static_cast<uint32_t>(port.min_time - block.min_time));
+            put_varint(data, static_cast<uint32_t>(port.max_time - port.min_time));
+            previous_port = port.port;
+        }
+        block.summary_size = static_cast<uint32_t>(data.size() - block.offset);
+
+        int32_t previous = 0;                       // Departure of the previous voyage.
+        for (size_t i = first; i < last; ++i) {
+            const uint32_t begin = store.begin(order[i]), end = store.end(order[i]);
+            put_varint(data, end - begin);
+            put_varint(data, archive_id(store.get_port(begin)));
+            put_signed(data, store.get_departure(begin).get_minutes() - previous);
+            previous = store.get_departure(begin).get_minutes();
+            for (uint32_t leg = begin + 1; leg < end; ++leg) {
+                put_varint(data, archive_id(store.get_port(leg)));
+                put_signed(data, store.get_minutes(leg));
+                put_varint(data, static_cast<uint32_t>(store.get_containers(leg)));
+                put_signed(data, store.get_departure(leg) - store.get_arrival(leg));
+            }
+        }
+        block.size = static_cast<uint32_t>(data.size() - block.offset);
+        blocks.push_back(block);
+    }
+    voyage_total = order.size();
+    fingerprints.clear();
+    for (const uint32_t v : order)
+        fingerprints.push_back(store.fingerprint(v, [&port_names](const uint32_t port) -> const std::string& {
+            return port_names[port];
+        }));
+    std::sort(fingerprints.begin(), fingerprints.end());
+    index();
+}
+
+bool VoyageArchive::index() {
+    ids.clear();
+    for (uint32_t port = 0; port < names.size(); ++port)
+        if (!ids.emplace(names[port], port).second) return false;       // Names must be unique.
+    sorted_ids.resize(names.size());
+    std::iota(sorted_ids.begin(), sorted_ids.end(), 0);
+    std::sort(sorted_ids.begin(), sorted_ids.end(),
+              [this](const uint32_t a, const uint32_t b) { return names[a] < names[b]; });
+
+    summary.clear();
+    summary_offsets.assign(1, 0);
+    for (const Block& block : blocks) {
+        if (block.offset > data.size() || block.size > data.size() - block.offset || block.summary_size > block.size)
+            return false;
+        ArchiveReader reader(data.data() + block.offset, data.data() + block.offset + block.summary_size);
+        const uint32_t count = reader.get();
+        uint32_t port = 0;
+        for (uint32_t i = 0; i < count && reader.is_valid(); ++i) {
+            const uint32_t step = reader.get();
+            if ((i > 0 && step == 0) || step >= names.size() - port) return false;     // Sorted, known ports.
+            port += step;
+            const int delta = reader.get_signed();
+            const uint32_t first = reader.get(), length = reader.get();
+            const long long min_time = static_cast<long long>(block.min_time) + first, max_time = min_time + length;
+            if (max_time > block.max_time) return false;                    // Inside the block.
+            summary.push_back(PortSummary{port, delta, static_cast<int32_t>(min_time), static_cast<int32_t>(max_time)});
+        }
+        if (!reader.at_end()) return false;
+        summary_offsets.push_back(static_cast<uint32_t>(summary.size()));
+    }
+
+    port_offsets.assign(names.size() + 1, 0);      // Counting sort of the summaries by port, blocks stay in order.
+    for (const PortSummary& entry : summary) ++port_offsets[entry.port + 1];
+    std::partial_sum(port_offsets.begin(), port_offsets.end(), port_offsets.begin());
+    port_blocks.resize(summary.size());
+    std::vector<uint32_t> next(port_offsets.begin(), port_offsets.end() - 1);
+    for (uint32_t block = 0; block < blocks.size(); ++block)
+        for (uint32_t i = summary_offsets[block]; i < summary_offsets[block + 1]; ++i)
+            port_blocks[next[summary[i].port]++] = PortBlock{block, i, 0, summary[i].max_time, summary[i].min_time};
+    for (uint32_t port = 0; port < names.size(); ++port) {
+        const uint32_t first = port_offsets[port], last = port_offsets[port + 1];
+        if (first == last) continue;                // A name of the dictionary no voyage touches.
+        for (uint32_t i = first + 1; i < last; ++i) {
+            port_blocks[i].before = port_blocks[i - 1].before + summary[port_blocks[i - 1].entry].delta;
+            port_blocks[i].max_before = std::max(port_blocks[i].max_before, port_blocks[i - 1].max_before);
+        }
+        for (uint32_t i = last - 1; i > first; --i)
+            port_blocks[i - 1].min_after = std::min(port_blocks[i - 1].min_after, port_blocks[i].min_after);
+    }
+    return true;
+}
+
+bool VoyageArchive::read_block(const size_t block, VoyageStore& legs) const {
+    const Block& entry = blocks[block];
+    legs.clear();
+    ArchiveReader reader(data.data() + entry.offset + entry.summary_size, data.data() + entry.offset + entry.size);
+    int32_t previous = 0;
+    for (uint32_t v = 0; v < entry.voyages && reader.is_valid(); ++v) {
+        const uint32_t count = reader.get();
+        const uint32_t source = reader.get();
+        previous += reader.get_signed();
+        if (count == 0 || source >= names.size() || !legs.begin_voyage(static_cast<int32_t>(v))) return false;
+        legs.add_leg(source, TimeStamp(previous), 0, 0);
+
+        int32_t departure = previous;               // Departure from the previous port.
+        for (uint32_t leg = 1; leg < count && reader.is_valid(); ++leg) {
+            const uint32_t port = reader.get();
+            const int32_t minutes = reader.get_signed();
+            const int32_t containers = static_cast<int32_t>(reader.get());
+            departure += minutes + reader.get_signed();
+            if (port >= names.size()) return false;
+            legs.add_leg(port, TimeStamp(departure), minutes, containers);
+        }
+    }
+    return reader.at_end();
+}
+
+void VoyageArchive::decode(const size_t block, VoyageStore& legs) const {
+    read_block(block, legs);                        // Validated by build or open.
+}
+
+void VoyageArchive::save(const std::string& file_name) const {
+    std::vector<char> payload;
+    std::vector<uint32_t> name_offsets(1, 0);
+    std::string characters;
+    for (const auto& name : names) {
+        characters += name;
+        name_offsets.push_back(static_cast<uint32_t>(characters.size()));
+    }
+    const uint32_t counts[] = {static_cast<uint32_t>(names.size()), static_cast<uint32_t>(blocks.size())};
+    put_array(payload, counts, 2);
+    put_array(payload, name_offsets.data(), name_offsets.size());
+    put_array(payload, characters.data(), characters.size());
+    put_array(payload, blocks.data(), blocks.size());
+    put_array(payload, data.data(), data.size());
+
+    ArchiveHeader header{};
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.header_size = sizeof(ArchiveHeader);
+    header.payload_size = payload.size();
+    header.checksum = checksum(payload.data(), payload.size());
+
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        throw FileNotFoundException(file_name);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!file)
+        throw FileNotFoundException(file_name);
+}
+
+void VoyageArchive::open(const std::string& file_name) {
+    const MappedFile file(file_name);
+    if (!file.is_open())
+        throw FileNotFoundException(file_name);
+
+    ArchiveHeader header{};
+    const size_t size = file.end() - file.begin();
+    if (size < sizeof(header))
+        throw InvalidArchiveException(file_name);
+    std::memcpy(&header, file.begin(), sizeof(header));
+    const char* position = file.begin() + sizeof(header);
+    if (std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0 || header.version != ARCHIVE_VERSION ||
+        header.header_size != sizeof(header) || header.payload_size != size - sizeof(header) ||
+        header.checksum != checksum(position, header.payload_size))
+        throw InvalidArchiveException(file_name);
+
+    VoyageArchive opened;
+    std::vector<uint32_t> counts, name_offsets;
+    std::vector<char> characters;
+    bool valid = get_array(position, file.end(), counts, 2) &&
+                 get_array(position, file.end(), name_offsets, static_cast<size_t>(counts[0]) + 1) &&
+                 name_offsets[0] == 0 && std::is_sorted(name_offsets.begin(), name_offsets.end()) &&
+                 get_array(position, file.end(), characters, name_offsets.back()) &&
+                 get_array(position, file.end(), opened.blocks, counts[1]);
+    if (valid) {
+        for (uint32_t port = 0; port < counts[0]; ++port)
+            opened.names.emplace_back(characters.data() + name_offsets[port], name_offsets[port + 1] - name_offsets[port]);
+        opened.data.assign(position, file.end());
+        valid = opened.index();
+    }
+
+    // Every block is decoded once, so queries never read past a block, and never skip a block they need.
+    VoyageStore legs;
+    const auto name = [&opened](const uint32_t port) -> const std::string& { return opened.names[port]; };
+    for (size_t block = 0; valid && block < opened.blocks.size(); ++block) {
+        const Block& entry = opened.blocks[block];
+        valid = opened.read_block(block, legs) && legs.size() == entry.voyages;
+        for (size_t v = 0; valid && v < legs.size(); ++v) {
+            legs.for_each_event(v, [&](const uint32_t port, const TimeStamp time, const int) {
+                const PortSummary* touched = opened.find_summary(block, port);
+                valid = valid && touched != nullptr && time.get_minutes() >= touched->min_time &&
+                        time.get_minutes() <= touched->max_time;
+            });
+            opened.fingerprints.push_back(legs.fingerprint(v, name));
+        }
+        opened.voyage_total += entry.voyages;
+    }
+    if (!valid)
+        throw InvalidArchiveException(file_name);
+    std::sort(opened.fingerprints.begin(), opened.fingerprints.end());
+    *this = std::move(opened);
+}
+
+bool VoyageArchive::contains(const uint64_t fingerprint) const {
+    return std::binary_search(fingerprints.begin(), fingerprints.end(), fingerprint);
+}
+
+bool VoyageArchive::overlaps(const VoyageArchive& other) const {
+    auto mine = fingerprints.begin();               // Both sorted, a single merge.
+    for (auto theirs = other.fingerprints.begin(); mine != fingerprints.end() && theirs != other.fingerprints.end(); ) {
+        if (*mine < *theirs) ++mine;
+        else if (*theirs < *mine) ++theirs;
+        else return true;
+    }
+    return false;
+}
+
+uint32_t VoyageArchive::find(const std::string& name) const {
+    const auto found = ids.find(name);
+    return found == ids.end() ? NO_PORT : found->second;
+}
+
+const VoyageArchive::PortSummary* VoyageArchive::find_summary(const size_t block, const uint32_t port) const {
+    const auto first = summary.begin() + summary_offsets[block], last = summary.begin() + summary_offsets[block + 1];
+    const auto found = std::lower_bound(first, last, port,
+                                        [](const PortSummary& entry, const uint32_t id) { return entry.port < id; });
+    return found != last && found->port == port ? &*found : nullptr;
+}
+
+int VoyageArchive::collect(const uint32_t port, const TimeStamp from, const TimeStamp to,
+                           std::vector<std::pair<TimeStamp, int>>& events) const {
+    static thread_local VoyageStore legs;           // Decoded block, reused by the queries of a thread.
+    const auto first = port_blocks.begin() + port_offsets[port], last = port_blocks.begin() + port_offsets[port + 1];
+    // Every block before begin ends before the window, every block from end starts after it.
+    const auto begin = std::partition_point(first, last, [from](const PortBlock& entry) {
+        return entry.max_before <= from.get_minutes();
+    });
+    const auto end = std::partition_point(begin, last, [to](const PortBlock& entry) {
+        return entry.min_after <= to.get_minutes();
+    });
+    int balance = begin == first ? 0 : (begin - 1)->before + summary[(begin - 1)->entry].delta;
+    for (auto entry = begin; entry != end; ++entry) {
+        const PortSummary& touched = summary[entry->entry];
+        if (touched.min_time > to.get_minutes()) continue;
+        if (touched.max_time <= from.get_minutes()) {               // Entirely before the window, no decoding.
+            balance += touched.delta;
+            continue;
+        }
+        decode(entry->block, legs);
+        for (size_t v = 0; v < legs.size(); ++v)
+            legs.for_each_event(v, [&](const uint32_t event_port, const TimeStamp time, const int delta) {
+                if (event_port != port) return;
+                if (time <= from) balance += delta;
+                else if (time <= to) events.emplace_back(time, delta);
+            });
+    }
+    return balance;
+}
+
+int VoyageArchive::balance_at(const std::string& port, const TimeStamp time) const {
+    const uint32_t id = find(port);
+    if (id == NO_PORT) return 0;
+    std::vector<std::pair<TimeStamp, int>> events;  // Stays empty, the window ends at time.
+    return collect(id, time, time, events);
+}
+
+void VoyageArchive::balance_series(const std::string& port, const TimeStamp from, const TimeStamp to, const int step,
+                                   std::vector<int>& balances) const {
+    balances.clear();
+    const uint32_t id = find(port);
+    if (step <= 0 || to < from || id == NO_PORT) return;
+
+    std::vector<std::pair<TimeStamp, int>> events;
+    int balance = collect(id, from, to, events);
+    std::stable_sort(events.begin(), events.end(),
+                     [](const std::pair<TimeStamp, int>& a, const std::pair<TimeStamp, int>& b) { return a.first < b.first; });
+    size_t next = 0;
+    for (long long time = from.get_minutes(); time <= to.get_minutes(); time += step) {
+        for (; next < events.size() && events[next].first.get_minutes() <= time; ++next)
+            balance += events[next].second;
+        balances.push_back(balance);
+    }
+}
+
+void VoyageArchive::balances_at(const TimeStamp time, std::vector<int>& balances) const {
+    static thread_local VoyageStore legs;
+    balances.assign(names.size(), 0);
+    for (size_t block = 0; block < blocks.size(); ++block) {
+        if (blocks[block].min_time > time.get_minutes()) continue;
+        if (blocks[block].max_time <= time.get_minutes()) {
+            for (uint32_t i = summary_offsets[block]; i < summary_offsets[block + 1]; ++i)
+                balances[summary[i].port] += summary[i].delta;
+            continue;
+        }
+        decode(block, legs);
+        for (size_t v = 0; v < legs.size(); ++v)
+            legs.for_each_event(v, [&](const uint32_t port, const TimeStamp event_time, const int delta) {
+                if (event_time <= time) balances[port] += delta;
+            });
+    }
+}
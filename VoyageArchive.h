@@ -0,0 +1,134 @@
+#ifndef VOYAGEARCHIVE_H
+#define VOYAGEARCHIVE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "PortInterner.h"
+#include "TimeStamp.h"
+#include "VoyageStore.h"
+
+#define ARCHIVE_MAGIC "CARGOARC"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_BLOCK_VOYAGES 128   // Voyages per block, the unit that is decoded or skipped.
+
+/**
+ *  VoyageArchive class
+ *  This class holds voyage history compressed, in the same format in memory and on disk.
+ *  Voyages are sorted by departure and cut into blocks of ARCHIVE_BLOCK_VOYAGES voyages, every leg is encoded as
+ *  varints: the port id in the archive dictionary, the minutes sailed and the departure delay (zigzag, the times are
+ *  deltas from the previous departure) and the containers, a few bytes per leg instead of 16 in a VoyageStore.
+ *  Every block has an index entry with the first and last time of its container events, and a summary with the
+ *  containers delta, first and last event of every port it touches. The summaries are indexed by port too, (see
+ *  PortBlock) so a balance query of a port binary searches its blocks: the blocks where the port ends before its window
+ *  are a prefix delta, the blocks where it starts after it are skipped, and only the few blocks where the events of
+ *  the port are cut by the window are decoded, O(log blocks + decoded blocks) per query.
+ *  The fingerprints of the voyages (see VoyageStore::fingerprint) are kept sorted in memory, 8 bytes per voyage, so the
+ *  Graph refuses a history that holds a loaded voyage, or a load of a voyage of the history. They are not saved,
+ *  they are computed when the archive is built or opened.
+ *
+ *  File format (native byte order):
+ *   - header: magic, version, payload size, and an FNV-1a checksum of the payload,
+ *   - port count, block count, port name offsets, characters,
+ *   - block index: (first time, last time, voyages, first byte, summary bytes, bytes) of every block,
+ *   - the blocks: summary (count, then port id delta, containers delta, first and last event per port), then the voyages,
+ *     (legs, source port, departure delta, then port, minutes, containers and departure delay per leg)
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers and value types,
+ *  the compiler-generated versions are enough.
+ ***/
+class VoyageArchive {
+public:
+    // Index entry of a block, saved as is.
+    struct Block {
+        int32_t min_time;       // Earliest container event of the block.
+        int32_t max_time;       // Latest container event of the block.
+        uint32_t voyages;       // Number of voyages.
+        uint32_t offset;        // First byte of the block in data.
+        uint32_t summary_size;  // Bytes of the port summary, the voyages follow it.
+        uint32_t size;          // Number of bytes.
+    };
+
+    // Summary of a port in a block, decoded from the block.
+    struct PortSummary {
+        uint32_t port;          // Archive port id.
+        int delta;              // Containers delta of all its events in the block.
+        int32_t min_time;       // Its earliest event in the block.
+        int32_t max_time;       // Its latest event in the block.
+    };
+
+    // A block of a port, in the block list of the port, built by index.
+    struct PortBlock {
+        uint32_t block;         // Block index.
+        uint32_t entry;         // Its summary entry of the port.
+        int before;             // Containers delta of the port in its earlier blocks.
+        int32_t max_before;     // Latest event of the port in this block and the earlier ones. (never decreases)
+        int32_t min_after;      // Earliest event of the port in this block and the later ones. (never decreases)
+    };
+
+private:
+    std::vector<std::string> names;                     // Archive port id -> port name. (the dictionary)
+    std::unordered_map<std::string, uint32_t> ids;      // Port name -> archive port id.
+    std::vector<uint32_t> sorted_ids;                   // Archive port ids sorted by name.
+    std::vector<Block> blocks;                          // Block index, in departure order.
+    std::vector<uint8_t> data;                          // The encoded blocks.
+    std::vector<uint32_t> summary_offsets{0};           // Block -> its first summary entry, decoded from data.
+    std::vector<PortSummary> summary;                   // Ports of every block, sorted by port.
+    std::vector<uint32_t> port_offsets;                 // Archive port id -> its first entry in port_blocks.
+    std::vector<PortBlock> port_blocks;                 // The blocks of every port, in block order.
+    size_t voyage_total = 0;                            // Number of voyages.
+    std::vector<uint64_t> fingerprints;                 // Fingerprints of the voyages, sorted.
+
+    bool index();       // Builds the name lookups, decodes the summaries and port blocks, false if data is invalid.
+    bool read_block(size_t block, VoyageStore& legs) const;     // Decodes a block, false if it is invalid.
+    const PortSummary* find_summary(size_t block, uint32_t port) const;     // Null if port is not in block.
+
+    // Returns the containers delta of port up to from, and adds its events in (from, to] into events.
+    // Binary searches the blocks of port, only the blocks between the boundaries are looked at.
+    int collect(uint32_t port, TimeStamp from, TimeStamp to, std::vector<std::pair<TimeStamp, int>>& events) const;
+
+public:
+    // Encodes every voyage of store that is not removed and has legs, (not of an empty file)
+    // port_names[id] is the name of port id in store.
+    void build(const VoyageStore& store, const std::vector<std::string>& port_names);
+
+    // Writes the archive into file_name, throws FileNotFoundException if the file cannot be written.
+    void save(const std::string& file_name) const;
+
+    // Replaces the archive with file_name, throws FileNotFoundException if the file cannot be read,
+    // InvalidArchiveException if it is not a valid archive. The archive is not changed if an exception is thrown.
+    void open(const std::string& file_name);
+
+    // Decodes the voyages of block into legs, (cleared first) their ports are archive port ids.
+    void decode(size_t block, VoyageStore& legs) const;
+
+    size_t block_count() const { return blocks.size(); }                        // Number of blocks.
+    size_t voyage_count() const { return voyage_total; }                        // Number of voyages.
+    size_t byte_count() const { return data.size(); }                           // Bytes of the encoded blocks.
+    const std::string& name(const uint32_t id) const { return names[id]; }      // Port name getter.
+    const std::vector<uint32_t>& sorted() const { return sorted_ids; }          // Port ids sorted by name.
+
+    // True if a voyage of the archive has fingerprint.
+    bool contains(uint64_t fingerprint) const;
+
+    // True if a voyage of other is also in the archive.
+    bool overlaps(const VoyageArchive& other) const;
+
+    // Returns the archive port id of name, or NO_PORT if no archived voyage touches it.
+    uint32_t find(const std::string& name) const;
+
+    // Container amount of port at time, over the archived voyages.
+    int balance_at(const std::string& port, TimeStamp time) const;
+
+    // Fills balances with balance_at(from), balance_at(from + step) ... up to to. (see Timeline::balance_series)
+    void balance_series(const std::string& port, TimeStamp from, TimeStamp to, int step,
+                        std::vector<int>& balances) const;
+
+    // Fills balances with the container amount of every archive port id at time.
+    void balances_at(TimeStamp time, std::vector<int>& balances) const;
+};
+
+#endif //VOYAGEARCHIVE_H
@@ -0,0 +1,56 @@
+#include "VoyageStore.h"
+#include "FileException.h"
+
+bool VoyageStore::begin_voyage(const int32_t id) {
+    if (!accepts(id))
+        return false;
+    if (size() == 0)
+        first_id = id;
+    offsets.push_back(offsets.back());
+    removed.push_back(false);
+    return true;
+}
+
+void VoyageStore::remove(const size_t voyage) {
+    if (removed[voyage]) return;
+    removed[voyage] = true;
+    ++removed_voyages;
+}
+
+void VoyageStore::clear() {
+    first_id = 0;
+    offsets.assign(1, 0);
+    ports.clear();
+    departures.clear();
+    minutes.clear();
+    containers.clear();
+    removed.clear();
+    removed_voyages = 0;
+}
+
+void VoyageStore::add_leg(const uint32_t port, const TimeStamp departure, const int leg_minutes,
+                          const int leg_containers) {
+    ports.push_back(port);
+    departures.push_back(departure.get_minutes());
+    minutes.push_back(leg_minutes);
+    containers.push_back(leg_containers);
+    ++offsets.back();
+}
+
+uint64_t VoyageStore::fingerprint_leg(uint64_t hash, const std::string& port, const int32_t departure,
+                                      const int32_t leg_minutes, const int32_t leg_containers) {
+    const uint32_t length = static_cast<uint32_t>(port.size());       // So names cannot run into each other.
+    const int32_t values[] = {departure, leg_minutes, leg_containers};
+    hash = checksum(reinterpret_cast<const char*>(&length), sizeof(length), hash);
+    hash = checksum(port.data(), port.size(), hash);
+    return checksum(reinterpret_cast<const char*>(values), sizeof(values), hash);
+}
+
+void VoyageStore::add(const int32_t id, const uint32_t source, const std::vector<SailDetails>& database,
+                      const std::vector<uint32_t>& destinations) {
+    if (!begin_voyage(id))
+        throw InvalidVoyageIdException(id);             // Its legs would extend the previous voyage.
+    for (size_t i = 0; i < database.size(); ++i)
+        add_leg(i == 0 ? source : destinations[i - 1], database[i].get_departure(),
+                database[i].get_timings(), database[i].get_containers());
+}
@@ -0,0 +1,116 @@
+#ifndef VOYAGESTORE_H
+#define VOYAGESTORE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SailDetails.h"
+#include "TimeStamp.h"
+#include "Utils.h"
+
+/**
+ *  VoyageStore class
+ *  This class holds the legs of every voyage loaded into the Graph, as columns (structure of arrays).
+ *  Voyages get consecutive unique ids (Graph::next_id), so voyage id - first id is the index of the voyage,
+ *  And the legs of voyage index v are [offsets[v], offsets[v + 1]) of every column.
+ *  The first leg of a voyage is its source port and departure, every other leg is a destination port,
+ *  the minutes sailed since the previous departure, the containers unloaded and the departure from it.
+ *  A leg is 16 bytes in 4 contiguous arrays, instead of a vector of SailDetails (each with a port name) per voyage,
+ *  And a scan over all voyages reads memory sequentially.
+ *  An unloaded voyage keeps its slot (so indexes and ids do not move), it is only marked removed.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers and value types,
+ *  the compiler-generated versions are enough.
+ ***/
+class VoyageStore {
+    int32_t first_id = 0;                   // Unique id of voyage index 0.
+    std::vector<uint32_t> offsets{0};       // Voyage index -> its first leg, size = voyages + 1.
+    std::vector<uint32_t> ports;            // Port id of every leg.
+    std::vector<int32_t> departures;        // Departure minutes of every leg.
+    std::vector<int32_t> minutes;           // Minutes from the previous departure to the arrival, 0 for the source.
+    std::vector<int32_t> containers;        // Containers of every leg, 0 for the source.
+    std::vector<bool> removed;              // Voyage index -> unloaded.
+    size_t removed_voyages = 0;             // Number of voyages marked removed.
+
+public:
+    // Starts a new voyage, returns false if id does not follow the id of the last voyage.
+    bool begin_voyage(int32_t id);
+
+    // True if id can start the next voyage.
+    bool accepts(const int32_t id) const { return size() == 0 || id == first_id + static_cast<int32_t>(size()); }
+
+    // Adds a leg to the last voyage started.
+    void add_leg(uint32_t port, TimeStamp departure, int leg_minutes, int leg_containers);
+
+    // Adds a whole parsed voyage, database[0] is the source, database[i] the leg into destinations[i - 1].
+    // Throws InvalidVoyageIdException (nothing added) if id does not follow the id of the last voyage.
+    void add(int32_t id, uint32_t source, const std::vector<SailDetails>& database,
+             const std::vector<uint32_t>& destinations);
+
+    // Marks voyage removed, its legs are skipped by scans from now on.
+    void remove(size_t voyage);
+
+    // Removes every voyage, keeping the memory of the columns. (see VoyageArchive::decode)
+    void clear();
+
+    size_t size() const { return offsets.size() - 1; }                          // Number of voyages, removed included.
+    size_t removed_count() const { return removed_voyages; }                    // Number of removed voyages.
+    bool is_removed(const size_t voyage) const { return removed[voyage]; }      // Removed check.
+    size_t index(const int32_t voyage_id) const { return static_cast<size_t>(voyage_id - first_id); }  // Voyage index.
+    size_t leg_count() const { return ports.size(); }                           // Number of legs.
+    int32_t id(const size_t voyage) const { return first_id + static_cast<int32_t>(voyage); }   // Voyage id.
+
+    uint32_t begin(const size_t voyage) const { return offsets[voyage]; }       // First leg of voyage.
+    uint32_t end(const size_t voyage) const { return offsets[voyage + 1]; }     // One past the last leg.
+
+    uint32_t get_port(const uint32_t leg) const { return ports[leg]; }                          // Port getter.
+    TimeStamp get_departure(const uint32_t leg) const { return TimeStamp(departures[leg]); }    // Departure getter.
+    int get_minutes(const uint32_t leg) const { return minutes[leg]; }                          // Minutes getter.
+    int get_containers(const uint32_t leg) const { return containers[leg]; }                    // Containers getter.
+
+    // Arrival at the port of leg, which is not the first leg of its voyage.
+    TimeStamp get_arrival(const uint32_t leg) const { return TimeStamp(departures[leg - 1] + minutes[leg]); }
+
+    // Hash of a voyage by its contents: the name of every port, (name(port id) returns it) every departure, and the
+    // minutes and containers of every leg after the source. A voyage has the same fingerprint in every VoyageStore,
+    // whatever its id and port ids, so a voyage loaded again is recognized. (see VoyageArchive::contains)
+    template<typename Name>
+    uint64_t fingerprint(const size_t voyage, Name name) const {
+        uint64_t hash = FNV_OFFSET;
+        for (uint32_t leg = begin(voyage); leg < end(voyage); ++leg) {
+            const bool source = leg == begin(voyage);
+            hash = fingerprint_leg(hash, name(ports[leg]), departures[leg], source ? 0 : minutes[leg],
+                                   source ? 0 : containers[leg]);
+        }
+        return hash;
+    }
+
+    // Adds a leg to the fingerprint of its voyage, (see fingerprint) 0 minutes and containers for the source.
+    static uint64_t fingerprint_leg(uint64_t hash, const std::string& port, int32_t departure, int32_t leg_minutes,
+                                    int32_t leg_containers);
+
+    // Calls event(port, time, delta) for every container event of voyage, the source loses all containers
+    // At departure, every other port gains its containers on arrival, departures wait for delayed arrivals.
+    template<typename F>
+    void for_each_event(const size_t voyage, F event) const {
+        const uint32_t first = begin(voyage), last = end(voyage);
+        if (last - first < 2) return;
+
+        const uint32_t source = ports[first];
+        TimeStamp time = get_departure(first);
+        int total = 0;
+        for (uint32_t leg = first + 1; leg < last; ++leg) {
+            total += containers[leg];
+            time = time + minutes[leg];                                     // Arrival at the port of leg.
+            if (ports[leg] != source)
+                event(ports[leg], time, containers[leg]);
+
+            if (time <= get_departure(leg))                                 // Check for any date delays
+                time = get_departure(leg);
+        }
+        event(source, get_departure(first), -total);
+    }
+};
+
+#endif //VOYAGESTORE_H
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <sys/resource.h>
+#include "NetworkGenerator.h"
+#include "GraphCheck.h"
+#include "ScannerCheck.h"
+#include "../Graph.h"
+#include "../IngestPool.h"
+#include "../LineScanner.h"
+#include "../OutputWriter.h"
+#include "../ResultWriter.h"
+
+/**
+ * Welcome to the benchmark!
+ * Generates synthetic networks at several scales, and times the hot paths of every command on them:
+ * Voyage::read (parse, once per line scanner kernel), Graph::add_file (ingest), balance, balance_series, balances, inbound, outbound, route, earliest, maxflow, top_ports, top_routes and print,
+ * Then archives the network, (see VoyageArchive) and measures balance queries over the archive as history.
+ * Every measurement is printed as a single JSON line, (machine-readable, one line per scale and operation)
+ * with ops/sec, latency percentiles in microseconds and the peak RSS of the process so far.
+ *
+ * USAGE: cargoBench [--scales 1000,10000] [--ports N] [--legs N] [--skew X] [--queries N] [--seed N] [--dir path]
+ *        cargoBench --verify N [--seed N]
+ *        --scales is a list of voyage counts, the port count grows with the scale unless --ports is given.
+ *        --verify runs N cases of the differential check of the line scanner kernels instead, (see ScannerCheck)
+ *        then the check of the Graph on edge case inputs, (see GraphCheck, its files are written into --dir)
+ *        and exits with 1 if any kernel disagrees with the original parser, or any Graph result with the expected one.
+ *        An unknown flag, or a flag without a value, prints this usage and exits with 2, --help prints it and exits.
+ * **/
+
+#define DEFAULT_SCALES "1000,10000,50000"
+#define DEFAULT_QUERIES 20000
+#define PRINT_REPEATS 5
+#define TOP_K 10                        // k of the top_ports / top_routes queries.
+#define BENCHMARK_BUFFER_SIZE (1 << 20)
+
+using Clock = std::chrono::steady_clock;
+
+// Discards everything written into it, inbound / outbound results are formatted but not printed.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(const int c) override { return c; }
+    std::streamsize xsputn(const char*, const std::streamsize n) override { return n; }
+};
+
+struct Options {
+    std::vector<unsigned> scales;
+    unsigned ports = 0;                 // 0 -> scale / 10
+    unsigned legs = 5;
+    double skew = 1.0;
+    unsigned queries = DEFAULT_QUERIES;
+    uint64_t seed = 1;
+    std::string directory = "bench_data";
+    unsigned verify = 0;                // Cases of the scanner check, 0 -> benchmark.
+};
+
+// Latencies of a single operation, in nanoseconds.
+class Measurement {
+    std::vector<double> latencies;
+    double total = 0;
+
+public:
+    void add(const double nanoseconds) {
+        latencies.push_back(nanoseconds);
+        total += nanoseconds;
+    }
+
+    // Prints a JSON line of the measurement.
+    void report(const std::string& operation, const unsigned voyages, const size_t ports) {
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [this](const double p) {
+            if (latencies.empty()) return 0.0;
+            return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))] / 1000;
+        };
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+
+        std::cout << "{\"operation\":\"" << operation << "\",\"voyages\":" << voyages << ",\"ports\":" << ports
+                  << ",\"ops\":" << latencies.size()
+                  << ",\"ops_per_sec\":" << (total > 0 ? latencies.size() * 1e9 / total : 0)
+                  << ",\"p50_us\":" << percentile(0.50) << ",\"p90_us\":" << percentile(0.90)
+                  << ",\"p99_us\":" << percentile(0.99)
+                  << ",\"max_us\":" << (latencies.empty() ? 0 : latencies.back() / 1000)
+                  << ",\"peak_rss_kb\":" << usage.ru_maxrss << "}" << std::endl;
+    }
+};
+
+// Runs operation once, returns its time in nanoseconds.
+template<typename Operation>
+static double time_of(Operation operation) {
+    const auto start = Clock::now();
+    operation();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+static std::vector<unsigned> parse_list(const std::string& list) {
+    std::vector<unsigned> values;
+    std::stringstream stream(list);
+    std::string value;
+    while (std::getline(stream, value, ','))
+        values.push_back(static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10)));
+    return values;
+}
+
+static void print_usage(std::ostream& out) {
+    out << "USAGE: cargoBench [--scales 1000,10000] [--ports N] [--legs N] [--skew X] [--queries N] [--seed N] [--dir path]\n"
+        << "       cargoBench --verify N [--seed N]\n";
+}
+
+// Reads the flags into options, false if a flag is unknown or has no value.
+static bool parse_options(const int argc, char* argv[], Options& options) {
+    options.scales = parse_list(DEFAULT_SCALES);
+    for (int k = 1; k < argc; k += 2) {
+        const std::string flag = argv[k];
+        if (k + 1 == argc) {
+            std::cerr << "Missing value of " << flag << "\n";
+            return false;
+        }
+        const std::string value = argv[k + 1];
+        if (flag == "--scales") options.scales = parse_list(value);
+        else if (flag == "--ports") options.ports = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (flag == "--legs") options.legs = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (flag == "--skew") options.skew = std::strtod(value.c_str(), nullptr);
+        else if (flag == "--queries") options.queries = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (flag == "--seed") options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (flag == "--dir") options.directory = value;
+        else if (flag == "--verify") options.verify = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else {
+            std::cerr << "Unknown flag " << flag << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Benchmarks every operation on a single generated network of voyages files.
+static void run_scale(const Options& options, const unsigned voyages) {
+    NetworkGenerator::Parameters parameters;
+    parameters.voyages = voyages;
+    parameters.ports = options.ports ? options.ports : std::max(10u, voyages / 10);
+    parameters.legs = options.legs;
+    parameters.hub_skew = options.skew;
+    parameters.seed = options.seed;
+    NetworkGenerator generator(parameters);
+
+    const std::string directory = options.directory + "/" + std::to_string(voyages);
+    const auto files = generator.write_files(directory);
+
+    // Voyage::read of every file in memory, once per kernel of the line scanner.
+    std::vector<std::string> contents;
+    for (const auto& file : files) {
+        std::ifstream input(file, std::ios::binary);
+        contents.emplace_back(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    for (const auto kernel : {LineScanner::Kernel::SCALAR, LineScanner::Kernel::SSE2, LineScanner::Kernel::AVX2}) {
+        if (!LineScanner::is_supported(kernel)) continue;
+        const LineScanner scanner(kernel);
+        Measurement parse;
+        for (const auto& content : contents) {
+            Voyage voyage;
+            parse.add(time_of([&]() { voyage.read(content.data(), content.data() + content.size(), scanner); }));
+        }
+        parse.report("parse_" + LineScanner::name(kernel), voyages, parameters.ports);
+    }
+
+    const auto parsed = IngestPool().parse(files);
+
+    Graph<std::string> graph;
+    Measurement ingest;
+    for (const auto& file : parsed) {
+        if (file.line_number != 0 || file.error) {
+            std::cerr << "Failed to parse " << file.file_name << std::endl;
+            continue;
+        }
+        const Voyage& voyage = file.voyage;
+        ingest.add(time_of([&]() {
+            graph.add_file(voyage.get_source(), voyage.get_details(), voyage.get_destinations(), file.file_name);
+        }));
+    }
+    ingest.report("ingest", voyages, parameters.ports);
+
+    // The same pseudo random queries for every operation, the first query also compiles the graph.
+    NetworkGenerator::Parameters query_parameters = parameters;
+    query_parameters.seed = options.seed + 1;
+    query_parameters.legs = 0;
+    NetworkGenerator queries(query_parameters);
+    std::vector<std::string> ports, dates;
+    for (unsigned q = 0; q < options.queries; ++q) {
+        const std::string voyage = queries.next_voyage();       // "<port>,<dd/mm HH:mm>\n"
+        const size_t comma = voyage.find(',');
+        ports.push_back(voyage.substr(0, comma));
+        dates.push_back(voyage.substr(comma + 1, DATE_LENGTH));
+    }
+
+    NullBuffer null_buffer;
+    std::ostream null_stream(&null_buffer);
+    ResultWriter writer(null_stream, ResultWriter::Format::TEXT, BENCHMARK_BUFFER_SIZE);
+
+    Measurement balance, balance_series, balances, inbound, outbound, route, earliest, maxflow, top_ports, top_routes, print;
+    for (unsigned q = 0; q < options.queries; ++q)
+        balance.add(time_of([&]() { volatile int result = graph.balance(ports[q], dates[q]); (void)result; }));
+    for (unsigned q = 0; q < options.queries; ++q)
+        inbound.add(time_of([&]() { graph.reachable_nodes_to_source(ports[q], writer); }));
+    for (unsigned q = 0; q < options.queries; ++q)
+        outbound.add(time_of([&]() { graph.get_immediate_neighbors(ports[q], writer); }));
+    for (unsigned q = 0; q + 1 < options.queries; ++q)
+        route.add(time_of([&]() { graph.fastest_route(ports[q], ports[q + 1], writer); }));
+    for (unsigned q = 0; q + 1 < options.queries; ++q)
+        earliest.add(time_of([&]() { graph.earliest_arrival(ports[q], ports[q + 1], dates[q], writer); }));
+    for (unsigned q = 0; q + 1 < options.queries; ++q)
+        maxflow.add(time_of([&]() { graph.max_flow(ports[q], ports[q + 1], writer); }));
+    for (unsigned q = 0; q < options.queries; ++q)
+        top_ports.add(time_of([&]() { graph.top_ports(TOP_K, q % 2 == 1, writer); }));
+    for (unsigned q = 0; q < options.queries; ++q)
+        top_routes.add(time_of([&]() { graph.top_routes(TOP_K, q % 2 == 1, writer); }));
+    for (unsigned r = 0; r < PRINT_REPEATS; ++r)
+        balance_series.add(time_of([&]() { graph.balance_series(ports[r], "01/01 00:00", "31/12 23:00", MINUTES, writer); }));
+    for (unsigned r = 0; r < PRINT_REPEATS; ++r)
+        balances.add(time_of([&]() { graph.balances(dates[r], writer); }));
+    const OutputWriter printer;
+    for (unsigned r = 0; r < PRINT_REPEATS; ++r)
+        print.add(time_of([&]() { graph.print("/dev/null", printer); }));
+    balance.report("balance", voyages, parameters.ports);
+    balance_series.report("balance_series", voyages, parameters.ports);
+    balances.report("balances", voyages, parameters.ports);
+    inbound.report("inbound", voyages, parameters.ports);
+    outbound.report("outbound", voyages, parameters.ports);
+    route.report("route", voyages, parameters.ports);
+    earliest.report("earliest", voyages, parameters.ports);
+    maxflow.report("maxflow", voyages, parameters.ports);
+    top_ports.report("top_ports", voyages, parameters.ports);
+    top_routes.report("top_routes", voyages, parameters.ports);
+    print.report("print", voyages, parameters.ports);
+
+    // The same network as history, compressed in an archive, queried without being loaded.
+    Measurement archive_build, archive_open, history_balance, history_balances;
+    VoyageArchive archive;
+    archive_build.add(time_of([&]() { graph.archive(archive); }));
+    const std::string archive_file = directory + "/history.arc";
+    archive.save(archive_file);
+    std::shared_ptr<VoyageArchive> opened(new VoyageArchive());
+    archive_open.add(time_of([&]() { opened->open(archive_file); }));
+    Graph<std::string> history;
+    history.set_history(opened, archive_file);
+    for (unsigned q = 0; q < options.queries; ++q)
+        history_balance.add(time_of([&]() { volatile int result = history.balance(ports[q], dates[q]); (void)result; }));
+    for (unsigned r = 0; r < PRINT_REPEATS; ++r)
+        history_balances.add(time_of([&]() { history.balances(dates[r], writer); }));
+    archive_build.report("archive_build", voyages, parameters.ports);
+    archive_open.report("archive_open", voyages, parameters.ports);
+    history_balance.report("history_balance", voyages, parameters.ports);
+    history_balances.report("history_balances", voyages, parameters.ports);
+
+    size_t text_bytes = 0;
+    for (const auto& file : files) text_bytes += std::ifstream(file, std::ios::binary | std::ios::ate).tellg();
+    std::cout << "{\"operation\":\"archive_size\",\"voyages\":" << voyages << ",\"ports\":" << parameters.ports
+              << ",\"blocks\":" << opened->block_count() << ",\"archive_bytes\":" << opened->byte_count()
+              << ",\"text_bytes\":" << text_bytes << "}" << std::endl;
+}
+
+int main(const int argc, char* argv[]) {
+    if (argc == 2 && (std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0)) {
+        print_usage(std::cout);
+        return 0;
+    }
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(std::cerr);
+        return 2;
+    }
+    if (options.verify > 0) {
+        const size_t mismatches = ScannerCheck(options.seed).run(options.verify);
+        const size_t graph_mismatches = GraphCheck(options.seed, options.directory + "/check").run();
+        std::string names;
+        for (const auto kernel : {LineScanner::Kernel::SCALAR, LineScanner::Kernel::SSE2, LineScanner::Kernel::AVX2})
+            if (LineScanner::is_supported(kernel)) names += (names.empty() ? "" : ",") + LineScanner::name(kernel);
+        std::cout << "{\"operation\":\"verify\",\"kernels\":\"" << names << "\",\"cases\":" << options.verify
+                  << ",\"mismatches\":" << mismatches << ",\"graph_mismatches\":" << graph_mismatches << "}" << std::endl;
+        return mismatches == 0 && graph_mismatches == 0 ? 0 : 1;
+    }
+    for (const unsigned voyages : options.scales)
+        run_scale(options, voyages);
+    return 0;
+}
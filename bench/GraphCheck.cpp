@@ -0,0 +1,143 @@
+#include "GraphCheck.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "../IngestPool.h"
+#include "../ResultWriter.h"
+#include "../Snapshot.h"
+
+#define CHECK_VOYAGES 40        // Generated voyage files around the edge cases.
+#define CHECK_PORTS 12
+#define CHECK_TOP_K 100         // More than the ports and lanes, so every one of them is compared.
+
+static const char* const CHECK_DATES[] = {"01/03 12:00", "15/06 12:00", "31/12 23:59"};     // Dates of balances.
+
+// Parameters of the generated voyage files.
+static NetworkGenerator::Parameters check_parameters(const uint64_t seed) {
+    NetworkGenerator::Parameters parameters;
+    parameters.voyages = CHECK_VOYAGES;
+    parameters.ports = CHECK_PORTS;
+    parameters.seed = seed;
+    return parameters;
+}
+
+// Prints a mismatch, returns 1 if actual is not expected.
+static size_t compare(const std::string& what, const std::string& expected, const std::string& actual) {
+    if (expected == actual) return 0;
+    std::cerr << "Mismatch in " << what << ":\n" << actual << "Expected:\n" << expected << std::endl;
+    return 1;
+}
+
+// The lines of text sorted, for results whose ties are ordered by port id, which differs between graphs.
+static std::string sorted_lines(const std::string& text) {
+    std::istringstream in(text);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line); ) lines.push_back(line);
+    std::sort(lines.begin(), lines.end());
+    std::string sorted;
+    for (const auto& line : lines) sorted += line + "\n";
+    return sorted;
+}
+
+GraphCheck::GraphCheck(const uint64_t seed, std::string _directory)
+: generator(check_parameters(seed)), directory(std::move(_directory)) {}
+
+size_t GraphCheck::load(Graph<std::string>& graph, const std::vector<std::string>& file_names) {
+    size_t failed = 0;
+    for (const auto& file : IngestPool().parse(file_names)) {
+        if (file.line_number != 0 || file.error) {
+            std::cerr << "Failed to parse " << file.file_name << std::endl;
+            ++failed;
+            continue;
+        }
+        const Voyage& voyage = file.voyage;
+        graph.add_file(voyage.get_source(), voyage.get_details(), voyage.get_destinations(), file.file_name);
+    }
+    return failed;
+}
+
+std::string GraphCheck::traffic(const Graph<std::string>& graph) {
+    std::ostringstream out;
+    ResultWriter writer(out);
+    graph.top_ports(CHECK_TOP_K, false, writer);
+    graph.top_ports(CHECK_TOP_K, true, writer);
+    graph.top_routes(CHECK_TOP_K, false, writer);
+    writer.flush();
+    return out.str();
+}
+
+std::string GraphCheck::results(const Graph<std::string>& graph) {
+    std::ostringstream out;
+    ResultWriter writer(out);
+    for (const char* date : CHECK_DATES)
+        graph.balances(date, writer);
+    writer.flush();
+    return out.str() + traffic(graph);
+}
+
+size_t GraphCheck::check_empty_file() {
+    const auto files = generator.write_files(directory);
+    const std::string empty = directory + "/empty.dat";
+    std::ofstream(empty, std::ios::trunc).close();
+    std::vector<std::string> with_empty(files);
+    with_empty.insert(with_empty.begin() + with_empty.size() / 2, empty);
+
+    Graph<std::string> reference, checked;
+    size_t mismatches = load(reference, files) + load(checked, with_empty);
+    mismatches += compare("top_ports / top_routes with an empty file", traffic(reference), traffic(checked));
+
+    const std::string snapshot = directory + "/empty.snp";
+    Snapshot::save(checked, snapshot);
+    Graph<std::string> restored;
+    Snapshot::restore(restored, snapshot);
+    mismatches += compare("balances / top_ports / top_routes after restore", results(checked), results(restored));
+
+    mismatches += compare("unload of an empty file", "1", std::to_string(restored.unload(empty)));
+    mismatches += compare("top_ports / top_routes after unload", traffic(reference), traffic(restored));
+    return mismatches;
+}
+
+size_t GraphCheck::check_empty_archive() {
+    const auto files = generator.write_files(directory);
+    const std::string empty = directory + "/empty.dat";
+    std::ofstream(empty, std::ios::trunc).close();
+    std::vector<std::string> with_empty(files);
+    with_empty.insert(with_empty.begin(), empty);
+
+    Graph<std::string> reference, checked;
+    size_t mismatches = load(reference, files) + load(checked, with_empty);
+    VoyageArchive archive;
+    checked.archive(archive);
+    const std::string archive_file = directory + "/empty.arc";
+    archive.save(archive_file);
+
+    std::shared_ptr<VoyageArchive> opened(new VoyageArchive());
+    opened->open(archive_file);                     // Throws InvalidArchiveException if it was written wrong.
+    Graph<std::string> history;
+    history.set_history(opened, archive_file);
+    std::ostringstream expected, actual;
+    ResultWriter expected_writer(expected), actual_writer(actual);
+    for (const char* date : CHECK_DATES) {
+        reference.balances(date, expected_writer);
+        history.balances(date, actual_writer);
+    }
+    expected_writer.flush();
+    actual_writer.flush();
+    mismatches += compare("balances over the archive as history", expected.str(), actual.str());
+
+    Graph<std::string> loaded;
+    loaded.add_archive(*opened, archive_file);
+    mismatches += compare("top_ports / top_routes of load_archive (sorted)", sorted_lines(traffic(reference)),
+                          sorted_lines(traffic(loaded)));             // Loaded in departure order, other port ids.
+    return mismatches;
+}
+
+size_t GraphCheck::run() {
+    try {
+        return check_empty_file() + check_empty_archive();
+    }catch (std::exception& e) {                    // A check that throws fails.
+        std::cerr << "Graph check failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
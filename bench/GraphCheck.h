@@ -0,0 +1,46 @@
+#ifndef GRAPHCHECK_H
+#define GRAPHCHECK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "NetworkGenerator.h"
+#include "../Graph.h"
+
+/**
+ *  GraphCheck class
+ *  Check of the Graph on edge case inputs, run by cargoBench --verify after the scanner check.
+ *  Generated voyage files are loaded with and without the edge case, and the results of the commands that must not
+ *  change (as the text a ResultWriter writes) are compared:
+ *   - an empty voyage file: top_ports and top_routes, the same after save and restore, and after unload,
+ *     and an archive of it: it is opened again, as history and by load_archive.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers and value types,
+ *  the compiler-generated versions are enough.
+ ***/
+class GraphCheck {
+    NetworkGenerator generator;         // The voyage files around the edge cases.
+    std::string directory;              // Where the files are written.
+
+    // Loads file_names (parsed by IngestPool) into graph, returns the number of files that failed.
+    static size_t load(Graph<std::string>& graph, const std::vector<std::string>& file_names);
+
+    // The results of the traffic commands (top_ports by containers and voyages, top_routes) of graph.
+    static std::string traffic(const Graph<std::string>& graph);
+
+    // The results of balances at a few dates, and of traffic.
+    static std::string results(const Graph<std::string>& graph);
+
+    size_t check_empty_file();          // Mismatches of a graph with an empty voyage file.
+    size_t check_empty_archive();       // Mismatches of an archive of a graph with an empty voyage file.
+
+public:
+    GraphCheck(uint64_t seed, std::string _directory);
+
+    // Runs every check, prints the mismatches into std::cerr, returns their number.
+    size_t run();
+};
+
+#endif //GRAPHCHECK_H
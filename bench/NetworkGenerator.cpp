@@ -0,0 +1,82 @@
+#include "NetworkGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sys/stat.h>
+#include "../TimeStamp.h"
+
+#define YEAR_MINUTES (365 * MINUTES_IN_DAY)
+#define MAX_SAIL_MINUTES (5 * MINUTES_IN_DAY)       // Longest leg.
+#define MAX_DWELL_MINUTES (2 * MINUTES_IN_DAY)      // Longest stay in a port.
+#define MAX_CONTAINERS 100
+
+NetworkGenerator::NetworkGenerator(const Parameters& _parameters) : parameters(_parameters), state(_parameters.seed) {
+    if (parameters.ports == 0) parameters.ports = 1;
+    double total = 0;
+    for (unsigned port = 0; port < parameters.ports; ++port) {
+        total += 1.0 / std::pow(port + 1.0, parameters.hub_skew);
+        popularity.push_back(total);
+    }
+    for (auto& probability : popularity)
+        probability /= total;
+}
+
+uint64_t NetworkGenerator::next() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+unsigned NetworkGenerator::uniform(const unsigned bound) {
+    return static_cast<unsigned>(next() % bound);
+}
+
+unsigned NetworkGenerator::pick_port() {
+    const double r = static_cast<double>(next() >> 11) / static_cast<double>(1ULL << 53);
+    const auto found = std::lower_bound(popularity.begin(), popularity.end(), r);
+    return static_cast<unsigned>(std::min<size_t>(found - popularity.begin(), popularity.size() - 1));
+}
+
+std::string NetworkGenerator::port_name(const unsigned port) {
+    return "P" + std::to_string(port);
+}
+
+std::string NetworkGenerator::next_voyage() {
+    // Start early enough in the year for all legs to fit.
+    const int longest = static_cast<int>(parameters.legs) * (MAX_SAIL_MINUTES + MAX_DWELL_MINUTES);
+    int time = static_cast<int>(uniform(static_cast<unsigned>(std::max(1, YEAR_MINUTES - longest - 1))));
+    unsigned port = pick_port();
+
+    std::string voyage = port_name(port) + "," + TimeStamp(time).format() + "\n";
+    for (unsigned leg = 0; leg < parameters.legs; ++leg) {
+        unsigned destination = pick_port();
+        if (destination == port) destination = (destination + 1) % parameters.ports;
+
+        time += MINUTES + static_cast<int>(uniform(MAX_SAIL_MINUTES));
+        const int arrival = time;
+        time += static_cast<int>(uniform(MAX_DWELL_MINUTES));
+        voyage += port_name(destination) + "," + TimeStamp(arrival).format() + "," +
+                  std::to_string(uniform(MAX_CONTAINERS)) + "," + TimeStamp(time).format() + "\n";
+        port = destination;
+    }
+    return voyage;
+}
+
+// mkdir -p, existing directories are fine.
+static void make_directories(const std::string& directory) {
+    for (size_t slash = directory.find('/', 1); slash != std::string::npos; slash = directory.find('/', slash + 1))
+        mkdir(directory.substr(0, slash).c_str(), 0755);
+    mkdir(directory.c_str(), 0755);
+}
+
+std::vector<std::string> NetworkGenerator::write_files(const std::string& directory) {
+    make_directories(directory);
+    std::vector<std::string> files;
+    for (unsigned v = 0; v < parameters.voyages; ++v) {
+        files.push_back(directory + "/voyage_" + std::to_string(v) + ".dat");
+        std::ofstream file(files.back(), std::ios::trunc);
+        file << next_voyage();
+    }
+    return files;
+}
@@ -0,0 +1,51 @@
+#ifndef NETWORKGENERATOR_H
+#define NETWORKGENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *  NetworkGenerator class
+ *  Generates reproducible synthetic voyage files, in the same format Voyage::read expects:
+ *  <port_name>,<departure_time> then <port_name>,<arrival_time>,<container_quantity>,<departure_time> per leg.
+ *  The same seed and parameters always produce the same files, on every platform.
+ *  Ports are picked with a Zipf-like distribution, a larger hub_skew makes a few ports (hubs)
+ *  appear in most voyages, 0 picks all ports uniformly.
+ *
+ *  The big 3:
+ *  Not implemented because this class only contains standard containers and value types,
+ *  the compiler-generated versions are enough.
+ ***/
+class NetworkGenerator {
+public:
+    struct Parameters {
+        unsigned ports = 100;           // Number of different ports.
+        unsigned voyages = 1000;        // Number of voyage files.
+        unsigned legs = 5;              // Legs per voyage, (lines after the first)
+        double hub_skew = 1.0;          // Zipf exponent of the port popularity.
+        uint64_t seed = 1;              // Random seed.
+    };
+
+private:
+    Parameters parameters;
+    std::vector<double> popularity;     // Cumulative probability of every port.
+    uint64_t state;                     // splitmix64 state.
+
+    uint64_t next();                    // Next random number.
+    unsigned uniform(unsigned bound);   // Random number in [0, bound).
+    unsigned pick_port();               // Random port, skewed towards the hubs.
+
+public:
+    explicit NetworkGenerator(const Parameters& _parameters);
+
+    static std::string port_name(unsigned port);    // Name of a port, "P<number>".
+
+    // Returns the contents of the next voyage file.
+    std::string next_voyage();
+
+    // Writes all voyages into directory, returns the file names in order.
+    std::vector<std::string> write_files(const std::string& directory);
+};
+
+#endif //NETWORKGENERATOR_H
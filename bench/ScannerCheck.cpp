@@ -0,0 +1,209 @@
+#include "ScannerCheck.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../LineScanner.h"
+#include "../Utils.h"
+#include "../Voyage.h"
+
+#define CHECK_PAGES 16          // Readable pages in front of the guard page, larger than any generated input.
+#define MAX_SLACK 40            // Most bytes left between an input and the guard page.
+#define MAX_REPORTS 10          // Mismatches printed into std::cerr.
+#define MUTATIONS "0123456789/: ,\nP\r-+"   // Characters used by mutate.
+#define INT_BOUNDARY 2147483646LL           // INT_MAX - 1, the counts around it are checked with leading zeros.
+
+static size_t reported = 0;
+
+// Prints a mismatch, the first MAX_REPORTS only.
+static size_t mismatch(const std::string& what, const std::string& input, const LineScanner::Kernel kernel) {
+    if (reported++ < MAX_REPORTS)
+        std::cerr << "Mismatch (" << LineScanner::name(kernel) << ") in " << what << ": \"" << input << "\"" << std::endl;
+    return 1;
+}
+
+// Kernels the CPU can run.
+static std::vector<LineScanner::Kernel> kernels() {
+    std::vector<LineScanner::Kernel> supported;
+    for (const auto kernel : {LineScanner::Kernel::SCALAR, LineScanner::Kernel::SSE2, LineScanner::Kernel::AVX2})
+        if (LineScanner::is_supported(kernel)) supported.push_back(kernel);
+    return supported;
+}
+
+// True if text (digits only) fits in an int, the way std::stoi of the original parser reads it.
+static bool fits_int(const std::string& text) {
+    try {
+        std::stoi(text);
+        return true;
+    }catch (std::out_of_range&) {
+        return false;
+    }
+}
+
+// The original file check: std::getline per line, split_line, check_input, std::stoi and calculate_time_minutes.
+static int reference_read(const std::string& text) {
+    std::istringstream stream(text);
+    std::string line;
+    TimeStamp departure;
+    for (int line_number = 1; std::getline(stream, line); ++line_number) {
+        const auto tokens = split_line(line);
+        if (line_number == 1) {
+            if (tokens.size() != 2 || !is_valid_port(tokens[0]) || !matchesDateTime(tokens[1], tokens[1]))
+                return line_number;
+        }else {
+            if (tokens.size() != 4 || !check_input(tokens[0], tokens[1], tokens[2], tokens[3]) || !fits_int(tokens[2]) ||
+                calculate_time_minutes(departure, datetime(tokens[1])) < 0)
+                return line_number;
+        }
+        departure = datetime(tokens.back());
+    }
+    return 0;
+}
+
+// True if 2 parsed voyages are the same.
+static bool same_voyage(const Voyage& a, const Voyage& b) {
+    if (a.get_source() != b.get_source() || a.get_destinations() != b.get_destinations() ||
+        a.get_details().size() != b.get_details().size())
+        return false;
+    for (size_t i = 0; i < a.get_details().size(); ++i) {
+        const SailDetails& x = a.get_details()[i];
+        const SailDetails& y = b.get_details()[i];
+        if (x.get_containers() != y.get_containers() || x.get_timings() != y.get_timings() ||
+            x.get_departure() != y.get_departure())
+            return false;
+    }
+    return true;
+}
+
+ScannerCheck::ScannerCheck(const uint64_t seed) : generator([seed]() {
+    NetworkGenerator::Parameters parameters;
+    parameters.ports = 50;
+    parameters.legs = 4;
+    parameters.seed = seed;
+    return parameters;
+}()), state(seed) {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    void* mapping = mmap(nullptr, (CHECK_PAGES + 1) * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) throw std::runtime_error("Cannot map the pages of the check.");
+    pages = static_cast<char*>(mapping);
+    guard = pages + CHECK_PAGES * page;
+    mprotect(guard, page, PROT_NONE);
+}
+
+ScannerCheck::~ScannerCheck() {
+    munmap(pages, (CHECK_PAGES + 1) * static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+}
+
+uint64_t ScannerCheck::next() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+unsigned ScannerCheck::uniform(const unsigned bound) {
+    return static_cast<unsigned>(next() % bound);
+}
+
+std::string ScannerCheck::mutate(std::string text, const unsigned count) {
+    static const std::string characters = MUTATIONS;
+    for (unsigned i = 0; i < count; ++i) {
+        const char character = characters[uniform(static_cast<unsigned>(characters.size()))];
+        const size_t at = uniform(static_cast<unsigned>(text.size() + 1));
+        const unsigned operation = uniform(3);
+        if (operation == 0 && at < text.size()) text[at] = character;
+        else if (operation == 1) text.insert(text.begin() + static_cast<long>(at), character);
+        else if (at < text.size()) text.erase(at, 1);
+    }
+    return text;
+}
+
+std::string ScannerCheck::random_date() {
+    const unsigned fields[4] = {uniform(40), uniform(20), uniform(30), uniform(70)};   // Day, month, hour, minute.
+    char text[DATE_LENGTH + 1];
+    std::snprintf(text, sizeof(text), "%02u/%02u %02u:%02u", fields[0], fields[1], fields[2], fields[3]);
+    return mutate(text, uniform(4) == 0 ? 1 + uniform(2) : 0);
+}
+
+std::string ScannerCheck::random_number() {
+    if (uniform(4) == 0)                                    // INT_MAX - 1, INT_MAX or INT_MAX + 1.
+        return std::string(uniform(4), '0') + std::to_string(INT_BOUNDARY + uniform(3));
+    std::string text;
+    const unsigned length = uniform(19);
+    for (unsigned i = 0; i < length; ++i)
+        text += static_cast<char>('0' + (i < 3 && uniform(4) == 0 ? 0 : uniform(10)));    // Some leading zeros.
+    return mutate(text, uniform(5) == 0 ? 1 : 0);
+}
+
+const char* ScannerCheck::place(const std::string& text, const size_t slack) {
+    char* begin = guard - slack - text.size();
+    std::memcpy(begin, text.data(), text.size());
+    return begin;
+}
+
+size_t ScannerCheck::check_file(const std::string& text) {
+    const int expected = reference_read(text);
+    const char* begin = place(text, uniform(4));
+    Voyage first;
+    size_t mismatches = 0;
+    for (const auto kernel : kernels()) {
+        Voyage voyage;
+        const int line_number = voyage.read(begin, begin + text.size(), LineScanner(kernel));
+        if (line_number != expected)
+            mismatches += mismatch("file, line " + std::to_string(line_number) + " instead of " +
+                                   std::to_string(expected), text, kernel);
+        else if (kernel == LineScanner::Kernel::SCALAR)
+            first = voyage;
+        else if (expected == 0 && !same_voyage(first, voyage))
+            mismatches += mismatch("file contents", text, kernel);
+    }
+    return mismatches;
+}
+
+size_t ScannerCheck::check_dates(const std::string& first, const std::string& second) {
+    const bool expected = matchesDateTime(first, second);
+    const std::string line = first + "," + second;              // Next to each other, like in a line.
+    const char* begin = place(line, uniform(MAX_SLACK));
+    size_t mismatches = 0;
+    for (const auto kernel : kernels()) {
+        TimeStamp arrival, departure;
+        const bool both = LineScanner(kernel).dates(begin, first.size(), begin + first.size() + 1, second.size(),
+                                                    guard, arrival, departure);
+        if (both != expected || (both && (arrival != datetime(first) || departure != datetime(second))))
+            mismatches += mismatch("dates", line, kernel);
+        const bool alone = LineScanner(kernel).dates(begin, first.size(), nullptr, 0, guard, arrival, departure);
+        if (alone != matchesDateTime(first, first) || (alone && arrival != datetime(first)))
+            mismatches += mismatch("date", first, kernel);
+    }
+    return mismatches;
+}
+
+size_t ScannerCheck::check_number(const std::string& text) {
+    const bool expected = is_number(text) && fits_int(text);
+    const char* begin = place(text, uniform(MAX_SLACK));
+    size_t mismatches = 0;
+    for (const auto kernel : kernels()) {
+        int value = -1;
+        const bool valid = LineScanner(kernel).number(begin, text.size(), guard, value);
+        if (valid != expected || (valid && value != std::stoi(text)))
+            mismatches += mismatch("number", text, kernel);
+    }
+    return mismatches;
+}
+
+size_t ScannerCheck::run(const unsigned cases) {
+    size_t mismatches = 0;
+    for (unsigned c = 0; c < cases; ++c) {
+        const unsigned mutations = uniform(3) == 0 ? 0 : 1 + uniform(3);   // A third of the files stay valid.
+        std::string file = mutate(generator.next_voyage(), mutations);
+        if (uniform(2) == 0) file.resize(uniform(static_cast<unsigned>(file.size() + 1)));    // Every length.
+        mismatches += check_file(file);
+        mismatches += check_dates(random_date(), random_date());
+        mismatches += check_number(random_number());
+    }
+    return mismatches;
+}
@@ -0,0 +1,48 @@
+#ifndef SCANNERCHECK_H
+#define SCANNERCHECK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "NetworkGenerator.h"
+
+/**
+ *  ScannerCheck class
+ *  Differential check of the LineScanner kernels, run by cargoBench --verify.
+ *  Generates voyage files, dates and container counts, valid ones, randomly mutated ones and cut ones,
+ *  and checks that every kernel the CPU supports accepts and rejects exactly what the original functions of Utils.cpp do,
+ *  (std::getline, split_line, is_valid_port, check_input, std::stoi) with the same values.
+ *  Every input ends a few bytes (or 0) before a page that cannot be read, so a kernel that reads past the end of
+ *  its input crashes the check instead of passing it.
+ *
+ *  The big 3:
+ *  The destructor unmaps the guarded pages, copying is deleted because 2 objects must never unmap the same memory.
+ ***/
+class ScannerCheck {
+    NetworkGenerator generator;         // Valid voyage files to mutate.
+    uint64_t state;                     // splitmix64 state.
+    char* pages = nullptr;              // Readable pages, followed by the guard page.
+    char* guard = nullptr;              // First byte that cannot be read.
+
+    uint64_t next();                                        // Next random number.
+    unsigned uniform(unsigned bound);                       // Random number in [0, bound).
+    std::string mutate(std::string text, unsigned count);   // Replaces, inserts or erases count characters.
+    std::string random_date();                              // A date with fields around their valid ranges.
+    std::string random_number();                            // Up to 18 digits or around INT_MAX, sometimes not digits.
+    const char* place(const std::string& text, size_t slack);   // Copies text to end slack bytes before guard.
+
+    size_t check_file(const std::string& text);             // Mismatches of a voyage file.
+    size_t check_dates(const std::string& first, const std::string& second);   // Mismatches of 2 dates.
+    size_t check_number(const std::string& text);           // Mismatches of a container count.
+
+public:
+    explicit ScannerCheck(uint64_t seed);
+    ScannerCheck(const ScannerCheck&) = delete;
+    ScannerCheck& operator=(const ScannerCheck&) = delete;
+    ~ScannerCheck();
+
+    // Checks cases files, dates and counts, prints the first mismatches into std::cerr, returns their number.
+    size_t run(unsigned cases);
+};
+
+#endif //SCANNERCHECK_H